@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+
+using py::operator""_p;
+
+PyObject *bench_add(PyObject*, long a, double b) {
+    return PyFloat_FromDouble(a + b);
+}
+
+/**
+   The same function written by hand with `PyArg_ParseTuple`.
+*/
+PyObject *bench_add_parse_tuple(PyObject*, PyObject *args) {
+    long a;
+    double b;
+
+    if (!PyArg_ParseTuple(args, "ld", &a, &b)) {
+        return nullptr;
+    }
+    return PyFloat_FromDouble(a + b);
+}
+
+/**
+   The same function written by hand with `PyArg_ParseTupleAndKeywords`.
+*/
+PyObject *bench_add_parse_keywords(PyObject*, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"a", "b", nullptr};
+    long a;
+    double b = 0.5;
+
+    if (!PyArg_ParseTupleAndKeywords(args,
+                                     kwargs,
+                                     "l|d",
+                                     const_cast<char**>(keywords),
+                                     &a,
+                                     &b)) {
+        return nullptr;
+    }
+    return PyFloat_FromDouble(a + b);
+}
+
+/**
+   Call a function wrapped with `automethod`.
+*/
+static void BM_automethod(benchmark::State &state) {
+    static PyMethodDef def = automethod(bench_add);
+    py::object f = PyCFunction_New(&def, nullptr);
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, 2.5_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_automethod);
+
+/**
+   Call a hand written `METH_VARARGS` function which uses
+   `PyArg_ParseTuple`.
+*/
+static void BM_parse_tuple(benchmark::State &state) {
+    static PyMethodDef def = {"bench_add_parse_tuple",
+                              bench_add_parse_tuple,
+                              METH_VARARGS,
+                              nullptr};
+    py::object f = PyCFunction_New(&def, nullptr);
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, 2.5_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_parse_tuple);
+
+/**
+   Call a function wrapped with `automethod_kw` passing a keyword argument.
+*/
+static void BM_automethod_kw(benchmark::State &state) {
+    using py::operator""_kw;
+
+    static PyMethodDef def = automethod_kw(bench_add,
+                                           nullptr,
+                                           "a"_kw,
+                                           "b"_kw = 0.5);
+    py::object f = PyCFunction_New(&def, nullptr);
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, "b"_kw = 2.5_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_automethod_kw);
+
+/**
+   Call a hand written `METH_VARARGS | METH_KEYWORDS` function which uses
+   `PyArg_ParseTupleAndKeywords` passing a keyword argument.
+*/
+static void BM_parse_keywords(benchmark::State &state) {
+    using py::operator""_kw;
+
+    static PyMethodDef def = {
+        "bench_add_parse_keywords",
+        (PyCFunction) (void(*)(void)) bench_add_parse_keywords,
+        METH_VARARGS | METH_KEYWORDS,
+        nullptr,
+    };
+    py::object f = PyCFunction_New(&def, nullptr);
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, "b"_kw = 2.5_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_parse_keywords);
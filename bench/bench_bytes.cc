@@ -0,0 +1,39 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+/**
+   Encode a payload into a `std::vector<char>` and copy it into `bytes`.
+*/
+static void BM_vector_then_copy(benchmark::State &state) {
+    const char record[] = "0123456789abcdef";
+    for (auto _ : state) {
+        std::vector<char> buffer;
+        for (int n = 0; n < state.range(0); ++n) {
+            buffer.insert(buffer.end(), record, record + sizeof(record) - 1);
+        }
+        py::object ob(PyBytes_FromStringAndSize(buffer.data(),
+                                                buffer.size()));
+        benchmark::DoNotOptimize((PyObject*) ob);
+        ob.decref();
+    }
+}
+BENCHMARK(BM_vector_then_copy)->Arg(64)->Arg(65536);
+
+/**
+   Encode a payload directly into `bytes` with `py::bytes::writer`.
+*/
+static void BM_writer(benchmark::State &state) {
+    const char record[] = "0123456789abcdef";
+    for (auto _ : state) {
+        py::bytes::writer w;
+        for (int n = 0; n < state.range(0); ++n) {
+            w.write(record, sizeof(record) - 1);
+        }
+        auto ob = w.finish();
+        benchmark::DoNotOptimize((PyObject*) ob);
+    }
+}
+BENCHMARK(BM_writer)->Arg(64)->Arg(65536);
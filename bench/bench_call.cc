@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+using py::operator""_p;
+
+/**
+   Compile a small python callable to use as the target of the calls.
+*/
+static py::object make_callable(const char *src) {
+    PyObject *ns = PyEval_GetBuiltins();
+    return PyRun_String(src, Py_eval_input, ns, ns);
+}
+
+/**
+   Call through `py::object::operator()`, which uses vectorcall when the
+   interpreter supports it.
+*/
+static void BM_call_operator(benchmark::State &state) {
+    py::object f = make_callable("lambda a, b: a");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, 2_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_operator);
+
+/**
+   Call by packing an argument tuple and using `PyObject_Call`. This is what
+   `operator()` did before vectorcall support.
+*/
+static void BM_call_tuple(benchmark::State &state) {
+    py::object f = make_callable("lambda a, b: a");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f.call(py::tuple::pack(1_p, 2_p));
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_tuple);
+
+/**
+   Same as `BM_call_operator` but calling a builtin function.
+*/
+static void BM_call_operator_builtin(benchmark::State &state) {
+    py::object f = make_callable("max");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, 2_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_operator_builtin);
+
+/**
+   Same as `BM_call_tuple` but calling a builtin function.
+*/
+static void BM_call_tuple_builtin(benchmark::State &state) {
+    py::object f = make_callable("max");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f.call(py::tuple::pack(1_p, 2_p));
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_tuple_builtin);
+
+/**
+   Call with a keyword argument using the `_kw` literal which caches the
+   interned keyword names per call site.
+*/
+static void BM_call_keywords(benchmark::State &state) {
+    using py::operator""_kw;
+
+    py::object f = make_callable("lambda a, b: a");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = f(1_p, "b"_kw = 2_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_keywords);
+
+/**
+   Call with a keyword argument by building a fresh `dict` for each call.
+*/
+static void BM_call_keywords_dict(benchmark::State &state) {
+    py::object f = make_callable("lambda a, b: a");
+
+    for (auto _ : state) {
+        py::tmpref<py::object> kwargs(PyDict_New());
+        kwargs.setitem("b"_p, 2_p);
+        py::tmpref<py::object> res = f.call(py::tuple::pack(1_p), kwargs);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+    f.decref();
+}
+BENCHMARK(BM_call_keywords_dict);
+
+/**
+   Call a method through `call_method` which avoids creating a bound method.
+*/
+static void BM_call_method(benchmark::State &state) {
+    py::object ob = "ayy.lmao"_p;
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = ob.call_method("find"_p, "."_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+}
+BENCHMARK(BM_call_method);
+
+/**
+   Call a method by looking up a bound method with `getattr` and then
+   calling it.
+*/
+static void BM_call_getattr(benchmark::State &state) {
+    py::object ob = "ayy.lmao"_p;
+
+    for (auto _ : state) {
+        py::tmpref<py::object> res = ob.getattr("find"_p)("."_p);
+        benchmark::DoNotOptimize((PyObject*) res);
+    }
+}
+BENCHMARK(BM_call_getattr);
+
+/**
+   Read a method and an instance attribute with `getattr`.
+*/
+static void BM_getattr(benchmark::State &state) {
+    py::object C = make_callable("type('C', (), {'f': lambda self: None})");
+    py::object ob = C();
+    ob.setattr("a"_p, 1_p);
+
+    for (auto _ : state) {
+        py::tmpref<py::object> f = ob.getattr("f"_p);
+        py::tmpref<py::object> a = ob.getattr("a"_p);
+        benchmark::DoNotOptimize((PyObject*) f);
+        benchmark::DoNotOptimize((PyObject*) a);
+    }
+    ob.decref();
+    C.decref();
+}
+BENCHMARK(BM_getattr);
+
+/**
+   Read a method and an instance attribute with `getattr` through an
+   `attr_cache`.
+*/
+static void BM_getattr_cached(benchmark::State &state) {
+    py::object C = make_callable("type('C', (), {'f': lambda self: None})");
+    py::object ob = C();
+    ob.setattr("a"_p, 1_p);
+
+    for (auto _ : state) {
+        static py::attr_cache f_cache;
+        static py::attr_cache a_cache;
+        py::tmpref<py::object> f = ob.getattr(f_cache, "f"_p);
+        py::tmpref<py::object> a = ob.getattr(a_cache, "a"_p);
+        benchmark::DoNotOptimize((PyObject*) f);
+        benchmark::DoNotOptimize((PyObject*) a);
+    }
+    ob.decref();
+    C.decref();
+}
+BENCHMARK(BM_getattr_cached);
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+using py::expr::lazy;
+
+/**
+   Evaluate `a + b * c - d` on floats with the eager operators, which box
+   every intermediate.
+*/
+static void BM_eager(benchmark::State &state) {
+    py::object a(PyFloat_FromDouble(1.5));
+    py::object b(PyFloat_FromDouble(2.5));
+    py::object c(PyFloat_FromDouble(-3.0));
+    py::object d(PyFloat_FromDouble(0.25));
+    for (auto _ : state) {
+        py::tmpref<py::object> r = a + b * c - d;
+        benchmark::DoNotOptimize((PyObject*) r);
+    }
+    a.decref();
+    b.decref();
+    c.decref();
+    d.decref();
+}
+BENCHMARK(BM_eager);
+
+/**
+   Evaluate `a + b * c - d` on floats as one lazy expression, which only
+   boxes the result.
+*/
+static void BM_lazy(benchmark::State &state) {
+    py::object a(PyFloat_FromDouble(1.5));
+    py::object b(PyFloat_FromDouble(2.5));
+    py::object c(PyFloat_FromDouble(-3.0));
+    py::object d(PyFloat_FromDouble(0.25));
+    for (auto _ : state) {
+        py::tmpref<py::object> r = lazy(a) + lazy(b) * c - d;
+        benchmark::DoNotOptimize((PyObject*) r);
+    }
+    a.decref();
+    b.decref();
+    c.decref();
+    d.decref();
+}
+BENCHMARK(BM_lazy);
+
+/**
+   Evaluate `a * b + c - d` on floats with every intermediate held in a
+   named `tmpref`, so each operator allocates its result.
+*/
+static void BM_named_intermediates(benchmark::State &state) {
+    py::object a(PyFloat_FromDouble(1.5));
+    py::object b(PyFloat_FromDouble(2.5));
+    py::object c(PyFloat_FromDouble(-3.0));
+    py::object d(PyFloat_FromDouble(0.25));
+    for (auto _ : state) {
+        py::tmpref<py::object> product = a * b;
+        py::tmpref<py::object> sum = product + c;
+        py::tmpref<py::object> r = sum - d;
+        benchmark::DoNotOptimize((PyObject*) r);
+    }
+    a.decref();
+    b.decref();
+    c.decref();
+    d.decref();
+}
+BENCHMARK(BM_named_intermediates);
+
+/**
+   Evaluate `a * b + c - d` on floats eagerly in one expression, where the
+   later operators write into the temporary from `a * b`.
+*/
+static void BM_temporary_intermediates(benchmark::State &state) {
+    py::object a(PyFloat_FromDouble(1.5));
+    py::object b(PyFloat_FromDouble(2.5));
+    py::object c(PyFloat_FromDouble(-3.0));
+    py::object d(PyFloat_FromDouble(0.25));
+    for (auto _ : state) {
+        py::tmpref<py::object> r = a * b + c - d;
+        benchmark::DoNotOptimize((PyObject*) r);
+    }
+    a.decref();
+    b.decref();
+    c.decref();
+    d.decref();
+}
+BENCHMARK(BM_temporary_intermediates);
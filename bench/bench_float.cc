@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+/**
+   Evaluate `a * b + c` on `float` objects through the number protocol.
+*/
+static void BM_number_protocol(benchmark::State &state) {
+    py::object a(PyFloat_FromDouble(1.5));
+    py::object b(PyFloat_FromDouble(2.5));
+    py::object c(PyFloat_FromDouble(-3.0));
+    for (auto _ : state) {
+        py::tmpref<py::object> product(PyNumber_Multiply(a, b));
+        py::tmpref<py::object> sum(PyNumber_Add(product, c));
+        benchmark::DoNotOptimize((PyObject*) sum);
+    }
+    a.decref();
+    b.decref();
+    c.decref();
+}
+BENCHMARK(BM_number_protocol);
+
+/**
+   Evaluate `a * b + c` on `py::float_::object`s with native doubles.
+*/
+static void BM_float_object(benchmark::State &state) {
+    auto a = py::float_::object(1.5).as_tmpref();
+    auto b = py::float_::object(2.5).as_tmpref();
+    auto c = py::float_::object(-3.0).as_tmpref();
+    for (auto _ : state) {
+        auto sum = a * b + c;
+        benchmark::DoNotOptimize((PyObject*) sum);
+    }
+}
+BENCHMARK(BM_float_object);
+
+/**
+   Evaluate `a * 2.5 + c` with a C++ double operand, which is never boxed.
+*/
+static void BM_float_object_double(benchmark::State &state) {
+    auto a = py::float_::object(1.5).as_tmpref();
+    auto c = py::float_::object(-3.0).as_tmpref();
+    for (auto _ : state) {
+        auto sum = a * 2.5 + c;
+        benchmark::DoNotOptimize((PyObject*) sum);
+    }
+}
+BENCHMARK(BM_float_object_double);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+using py::operator""_p;
+
+/**
+   Look up a cached string literal.
+*/
+static void BM_string_literal(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize((PyObject*) "literal"_p);
+    }
+}
+BENCHMARK(BM_string_literal);
+
+/**
+   Look up a cached integer literal.
+*/
+static void BM_integer_literal(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize((PyObject*) 12345_p);
+    }
+}
+BENCHMARK(BM_integer_literal);
+
+/**
+   Look up a cached float literal.
+*/
+static void BM_float_literal(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize((PyObject*) 2.5_p);
+    }
+}
+BENCHMARK(BM_float_literal);
+
+/**
+   Look up a cached character literal.
+*/
+static void BM_char_literal(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize((PyObject*) 'c'_p);
+    }
+}
+BENCHMARK(BM_char_literal);
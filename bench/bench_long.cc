@@ -0,0 +1,114 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+using py::operator""_p;
+
+/**
+   Step a 40 bit multiplicative hash through the number protocol.
+*/
+static void BM_long_number_protocol(benchmark::State &state) {
+    py::object factor(PyLong_FromLong(31));
+    py::object mask(PyLong_FromLongLong((1LL << 40) - 1));
+    for (auto _ : state) {
+        py::tmpref<py::object> n(PyLong_FromLongLong(1LL << 35));
+        for (int i = 0; i < 100; ++i) {
+            py::tmpref<py::object> step(PyNumber_Multiply(n, factor));
+            n = py::tmpref<py::object>(PyNumber_And(step, mask));
+        }
+        benchmark::DoNotOptimize((PyObject*) n);
+    }
+    factor.decref();
+    mask.decref();
+}
+BENCHMARK(BM_long_number_protocol);
+
+/**
+   Step a 40 bit multiplicative hash with `py::long_::object` operators,
+   which compute on machine words.
+*/
+static void BM_long_object(benchmark::State &state) {
+    for (auto _ : state) {
+        auto n = py::long_::object(1LL << 35).as_tmpref();
+        for (int i = 0; i < 100; ++i) {
+            n = (n * 31_p) & 0xffffffffff_p;
+        }
+        benchmark::DoNotOptimize((PyObject*) n);
+    }
+}
+BENCHMARK(BM_long_object);
+
+/**
+   Step a 40 bit multiplicative hash with C++ integer operands, which are
+   never boxed.
+*/
+static void BM_long_object_integer(benchmark::State &state) {
+    for (auto _ : state) {
+        auto n = py::long_::object(1LL << 35).as_tmpref();
+        for (int i = 0; i < 100; ++i) {
+            n = (n * 31) & 0xffffffffffLL;
+        }
+        benchmark::DoNotOptimize((PyObject*) n);
+    }
+}
+BENCHMARK(BM_long_object_integer);
+
+/**
+   Convert a list of ints to C++ one element at a time.
+*/
+static void BM_as_long_long_loop(benchmark::State &state) {
+    std::vector<long long> values(state.range(0));
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        values[ix] = ix * 1000;
+    }
+    auto list = py::long_::from_span(py::span<const long long>(values));
+    for (auto _ : state) {
+        std::vector<long long> out;
+        out.reserve(list.len());
+        for (const py::object &item : list) {
+            out.push_back(py::long_::object(item).as_long_long());
+            if (PyErr_Occurred()) {
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_as_long_long_loop)->Arg(1 << 20);
+
+/**
+   Convert a list of ints to C++ with `py::long_::to_vector`.
+*/
+static void BM_to_vector(benchmark::State &state) {
+    std::vector<long long> values(state.range(0));
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        values[ix] = ix * 1000;
+    }
+    auto list = py::long_::from_span(py::span<const long long>(values));
+    for (auto _ : state) {
+        auto out = py::long_::to_vector<long long>(list);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_to_vector)->Arg(1 << 20);
+
+/**
+   Box enum-like codes in `[0, 4096)`, with the box cache enabled when the
+   argument is 1.
+*/
+static void BM_box_cache(benchmark::State &state) {
+    if (state.range(0) && py::long_::enable_box_cache(0, 65535)) {
+        state.SkipWithError("enable_box_cache failed");
+        return;
+    }
+    long long code = 0;
+    for (auto _ : state) {
+        auto ob = py::long_::object(code).as_tmpref();
+        benchmark::DoNotOptimize((PyObject*) ob);
+        code = (code + 257) & 4095;
+    }
+    py::long_::disable_box_cache();
+}
+BENCHMARK(BM_box_cache)->Arg(0)->Arg(1);
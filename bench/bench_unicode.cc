@@ -0,0 +1,120 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "libpy/libpy.h"
+
+using py::operator""_p;
+
+namespace {
+    /**
+       A log line with `fields` comma separated fields.
+    */
+    py::unicode::object make_line(int fields) {
+        std::string s;
+        for (int n = 0; n < fields; ++n) {
+            if (n) {
+                s += ',';
+            }
+            s += "field";
+            s += std::to_string(n);
+        }
+        return PyUnicode_FromStringAndSize(s.data(), s.size());
+    }
+}
+
+/**
+   Split a line by calling `str.split` through `getattr`.
+*/
+static void BM_split_getattr(benchmark::State &state) {
+    auto line = make_line(state.range(0));
+    for (auto _ : state) {
+        auto pieces = line.getattr("split"_p)(","_p);
+        benchmark::DoNotOptimize((PyObject*) pieces);
+    }
+    line.decref();
+}
+BENCHMARK(BM_split_getattr)->Arg(8)->Arg(64);
+
+/**
+   Split a line with `py::unicode::object::split`.
+*/
+static void BM_split(benchmark::State &state) {
+    auto line = make_line(state.range(0));
+    for (auto _ : state) {
+        auto pieces = line.split(","_p);
+        benchmark::DoNotOptimize((PyObject*) pieces);
+    }
+    line.decref();
+}
+BENCHMARK(BM_split)->Arg(8)->Arg(64);
+
+/**
+   Find a substring near the end of a line by calling `str.find` through
+   `getattr`.
+*/
+static void BM_find_getattr(benchmark::State &state) {
+    auto line = make_line(state.range(0));
+    for (auto _ : state) {
+        auto idx = line.getattr("find"_p)("field7,"_p);
+        benchmark::DoNotOptimize((PyObject*) idx);
+    }
+    line.decref();
+}
+BENCHMARK(BM_find_getattr)->Arg(8)->Arg(64);
+
+/**
+   Find a substring near the end of a line with
+   `py::unicode::object::find`.
+*/
+static void BM_find(benchmark::State &state) {
+    auto line = make_line(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(line.find("field7,"_p));
+    }
+    line.decref();
+}
+BENCHMARK(BM_find)->Arg(8)->Arg(64);
+
+/**
+   Build a record by concatenating with `operator+`.
+*/
+static void BM_concat(benchmark::State &state) {
+    for (auto _ : state) {
+        auto record = ("id="_p + "1234"_p + ",name="_p + "ayy"_p +
+                       ",value="_p + "lmao"_p);
+        benchmark::DoNotOptimize((PyObject*) record);
+    }
+}
+BENCHMARK(BM_concat);
+
+/**
+   Build a record with `py::unicode::builder`.
+*/
+static void BM_builder(benchmark::State &state) {
+    py::unicode::builder b;
+    for (auto _ : state) {
+        auto record = b.append("id=")
+            .append(1234)
+            .append(",name=")
+            .append("ayy"_p)
+            .append(",value=")
+            .append("lmao"_p)
+            .build();
+        benchmark::DoNotOptimize((PyObject*) record);
+    }
+}
+BENCHMARK(BM_builder);
+
+/**
+   Build a record with a compile time format string.
+*/
+static void BM_format(benchmark::State &state) {
+    using py::operator""_fmt;
+
+    for (auto _ : state) {
+        auto record = "id={},name={},value={}"_fmt(1234, "ayy"_p, "lmao"_p);
+        benchmark::DoNotOptimize((PyObject*) record);
+    }
+}
+BENCHMARK(BM_format);
@@ -0,0 +1,11 @@
+#include <benchmark/benchmark.h>
+#include <Python.h>
+
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  Py_Initialize();
+  benchmark::RunSpecifiedBenchmarks();
+  Py_Finalize();
+  return 0;
+}
@@ -1,75 +1,573 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <Python.h>
 
+#include "libpy/long.h"
 #include "libpy/object.h"
 #include "libpy/utils.h"
 
+// METH_FASTCALL is public and takes `(self, args, nargs)` since 3.7
+#define HAVE_METH_FASTCALL (PY_VERSION_HEX >= 0x03070000)
+
+// std::optional return values can be boxed when building as C++17
+#define HAVE_OPTIONAL (__cplusplus >= 201703L)
+
+#if HAVE_OPTIONAL
+#include <optional>
+#endif
+
 namespace pyutils {
     /**
-       The format character for the given type. The default case is left
-       unitialized to generate a compile-time error if you attempt to use
-       auto method on a type that has no format character.
+       Converter from a Python object to a C++ value for a single argument
+       of an automethod. The default case is left undefined to generate a
+       compile-time error if you attempt to use automethod on a type that has
+       no converter.
+
+       Each converter provides:
+       `static bool convert(PyObject *ob, T &out)` which returns false with
+       a Python exception set on failure.
+    */
+    template<typename T, typename = void>
+    struct _converter;
+
+    /**
+       Raise the `TypeError` that `PyArg_ParseTuple` raises when an integer
+       argument gets a `float`.
+    */
+    inline bool _reject_float(PyObject *ob) {
+        if (PyFloat_Check(ob)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "integer argument expected, got float");
+            return true;
+        }
+        return false;
+    }
+
+    /**
+       Signed integers are range checked and raise an `OverflowError`
+       if they do not fit in `T`.
     */
     template<typename T>
-    constexpr char typeformat;
+    struct _converter<T, std::enable_if_t<std::is_integral<T>::value &&
+                                          std::is_signed<T>::value>> {
+        static inline bool convert(PyObject *ob, T &out) {
+            long long value;
 
-    template<>
-    constexpr char typeformat<const char*> = 'z';
+            if (PyLong_CheckExact(ob)) {
+                value = PyLong_AsLongLong(ob);
+            }
+            else {
+                if (_reject_float(ob)) {
+                    return false;
+                }
+                value = PyLong_AsLongLong(ob);
+            }
+            if (value == -1 && PyErr_Occurred()) {
+                return false;
+            }
+            if (value > std::numeric_limits<T>::max()) {
+                PyErr_SetString(PyExc_OverflowError,
+                                "signed integer is greater than maximum");
+                return false;
+            }
+            if (value < std::numeric_limits<T>::min()) {
+                PyErr_SetString(PyExc_OverflowError,
+                                "signed integer is less than minimum");
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
-    template<>
-    constexpr char typeformat<Py_buffer> = 's';
+    /**
+       Unsigned integers are converted without overflow checking, matching
+       the `H`, `I`, `k`, and `K` format characters.
+    */
+    template<typename T>
+    struct _converter<T, std::enable_if_t<std::is_integral<T>::value &&
+                                          std::is_unsigned<T>::value>> {
+        static inline bool convert(PyObject *ob, T &out) {
+            if (!PyLong_Check(ob)) {
+                PyErr_Format(PyExc_TypeError,
+                             "integer argument expected, got %.200s",
+                             Py_TYPE(ob)->tp_name);
+                return false;
+            }
+            unsigned long long value = PyLong_AsUnsignedLongLongMask(ob);
+            if (value == (unsigned long long) -1 && PyErr_Occurred()) {
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
+    /**
+       `unsigned char` is range checked, matching the `b` format character.
+    */
     template<>
-    constexpr char typeformat<char> = 'c';
+    struct _converter<unsigned char> {
+        static inline bool convert(PyObject *ob, unsigned char &out) {
+            if (_reject_float(ob)) {
+                return false;
+            }
+            long value = PyLong_AsLong(ob);
+            if (value == -1 && PyErr_Occurred()) {
+                return false;
+            }
+            if (value < 0) {
+                PyErr_SetString(PyExc_OverflowError,
+                                "unsigned byte integer is less than minimum");
+                return false;
+            }
+            if (value > std::numeric_limits<unsigned char>::max()) {
+                PyErr_SetString(
+                    PyExc_OverflowError,
+                    "unsigned byte integer is greater than maximum");
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
+    /**
+       `char` is read from a `bytes` or `bytearray` of length 1, matching the
+       `c` format character.
+    */
     template<>
-    constexpr char typeformat<unsigned char> = 'b';
+    struct _converter<char> {
+        static inline bool convert(PyObject *ob, char &out) {
+            if (PyBytes_Check(ob) && PyBytes_GET_SIZE(ob) == 1) {
+                out = PyBytes_AS_STRING(ob)[0];
+                return true;
+            }
+            if (PyByteArray_Check(ob) && PyByteArray_GET_SIZE(ob) == 1) {
+                out = PyByteArray_AS_STRING(ob)[0];
+                return true;
+            }
+            PyErr_Format(PyExc_TypeError,
+                         "expected a byte string of length 1, not %.200s",
+                         Py_TYPE(ob)->tp_name);
+            return false;
+        }
+    };
 
+    /**
+       `bool` uses the truthiness of the object, matching the `p` format
+       character.
+    */
     template<>
-    constexpr char typeformat<short> = 'h';
+    struct _converter<bool> {
+        static inline bool convert(PyObject *ob, bool &out) {
+            if (ob == Py_True) {
+                out = true;
+                return true;
+            }
+            if (ob == Py_False) {
+                out = false;
+                return true;
+            }
 
-    template<>
-    constexpr char typeformat<unsigned short> = 'H';
+            int value = PyObject_IsTrue(ob);
+            if (value < 0) {
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
-    template<>
-    constexpr char typeformat<int> = 'i';
+    template<typename T>
+    struct _converter<T,
+                      std::enable_if_t<std::is_floating_point<T>::value>> {
+        static inline bool convert(PyObject *ob, T &out) {
+            if (PyFloat_CheckExact(ob)) {
+                out = PyFloat_AS_DOUBLE(ob);
+                return true;
+            }
+
+            double value = PyFloat_AsDouble(ob);
+            if (value == -1.0 && PyErr_Occurred()) {
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
     template<>
-    constexpr char typeformat<unsigned int> = 'I';
+    struct _converter<Py_complex> {
+        static inline bool convert(PyObject *ob, Py_complex &out) {
+            Py_complex value = PyComplex_AsCComplex(ob);
+            if (value.real == -1.0 && PyErr_Occurred()) {
+                return false;
+            }
+            out = value;
+            return true;
+        }
+    };
 
+    /**
+       `const char*` accepts `str` or `None`, matching the `z` format
+       character. Strings with embedded null characters are rejected
+       because the function would only see the part before the first one.
+       The buffer is owned by the `str` object.
+    */
     template<>
-    constexpr char typeformat<long> = 'l';
+    struct _converter<const char*> {
+        static inline bool convert(PyObject *ob, const char *&out) {
+            if (ob == Py_None) {
+                out = nullptr;
+                return true;
+            }
+            if (!PyUnicode_Check(ob)) {
+                PyErr_Format(PyExc_TypeError,
+                             "expected str or None, not %.200s",
+                             Py_TYPE(ob)->tp_name);
+                return false;
+            }
+            Py_ssize_t size;
+            if (!(out = PyUnicode_AsUTF8AndSize(ob, &size))) {
+                return false;
+            }
+            if (std::strlen(out) != static_cast<std::size_t>(size)) {
+                PyErr_SetString(PyExc_ValueError, "embedded null character");
+                return false;
+            }
+            return true;
+        }
+    };
 
+    /**
+       Objects are passed through as borrowed references.
+    */
     template<>
-    constexpr char typeformat<unsigned long> = 'k';
+    struct _converter<PyObject*> {
+        static inline bool convert(PyObject *ob, PyObject *&out) {
+            out = ob;
+            return true;
+        }
+    };
 
     template<>
-    constexpr char typeformat<long long> = 'L';
+    struct _converter<py::object> {
+        static inline bool convert(PyObject *ob, py::object &out) {
+            out = py::object(ob);
+            return true;
+        }
+    };
+
+    /**
+       Storage for a single parsed argument.
+    */
+    template<typename T>
+    struct _argument {
+        T value;
+
+        inline bool convert(PyObject *ob) {
+            return _converter<T>::convert(ob, value);
+        }
+    };
 
+    /**
+       `Py_buffer` arguments are acquired with `PyBUF_SIMPLE` and released
+       after the wrapped function returns.
+    */
     template<>
-    constexpr char typeformat<unsigned long long> = 'K';
+    struct _argument<Py_buffer> {
+        Py_buffer value;
+        bool acquired = false;
+
+        inline bool convert(PyObject *ob) {
+            return (acquired = !PyObject_GetBuffer(ob, &value, PyBUF_SIMPLE));
+        }
+
+        ~_argument() {
+            if (acquired) {
+                PyBuffer_Release(&value);
+            }
+        }
+    };
+
+    /**
+       Boxer from a C++ value returned by a wrapped function to a new
+       reference to a Python object. The default case is left undefined to
+       generate a compile-time error if you attempt to use automethod on a
+       function whose return type has no boxer.
+
+       Each boxer provides:
+       `static PyObject *box(const T &value)` which returns nullptr with a
+       Python exception set on failure.
+    */
+    template<typename T, typename = void>
+    struct _boxer;
+
+    /**
+       Box a value with the boxer selected for its type.
+    */
+    template<typename T>
+    inline PyObject *_box(T &&value) {
+        return _boxer<std::decay_t<T>>::box(std::forward<T>(value));
+    }
 
+    /**
+       `PyObject*` is assumed to already be a new reference.
+    */
     template<>
-    constexpr char typeformat<float> = 'f';
+    struct _boxer<PyObject*> {
+        static inline PyObject *box(PyObject *value) {
+            return value;
+        }
+    };
+
+    template<typename T>
+    struct _is_tmpref : std::false_type {};
+
+    template<typename T>
+    struct _is_tmpref<py::tmpref<T>> : std::true_type {};
+
+    template<typename T>
+    struct _is_tmpref<py::ownedref<T>> : std::true_type {};
+
+    /**
+       libpy objects are assumed to already be a new reference, the same as
+       when they are returned as a `PyObject*`.
+    */
+    template<typename T>
+    struct _boxer<T, std::enable_if_t<std::is_base_of<py::object, T>::value &&
+                                      !_is_tmpref<T>::value>> {
+        static inline PyObject *box(const T &value) {
+            return (PyObject*) value;
+        }
+    };
+
+    /**
+       `tmpref`s give up their reference instead of decrefing it when they
+       are destroyed.
+    */
+    template<typename T>
+    struct _boxer<T, std::enable_if_t<_is_tmpref<T>::value>> {
+        static inline PyObject *box(T &&value) {
+            PyObject *ob = value;
+            std::move(value).invalidate();
+            return ob;
+        }
+    };
 
+    /**
+       `bool` returns the `True` or `False` singletons without calling into
+       `PyBool_FromLong`.
+    */
     template<>
-    constexpr char typeformat<double> = 'd';
+    struct _boxer<bool> {
+        static inline PyObject *box(bool value) {
+            PyObject *ob = value ? Py_True : Py_False;
+            Py_INCREF(ob);
+            return ob;
+        }
+    };
 
+    /**
+       `char` is boxed as a `bytes` of length 1, the inverse of its
+       converter.
+    */
     template<>
-    constexpr char typeformat<Py_complex> = 'D';
+    struct _boxer<char> {
+        static inline PyObject *box(char value) {
+            return PyBytes_FromStringAndSize(&value, 1);
+        }
+    };
+
+    /**
+       Integers are boxed like every other C++ integer in libpy, so values in
+       `[-5, 256]` come from CPython's small int cache and values in the
+       range of `py::long_::enable_box_cache` come from the box cache, neither
+       of which allocates.
+    */
+    template<typename T>
+    struct _boxer<T, std::enable_if_t<std::is_integral<T>::value &&
+                                      !std::is_same<T, bool>::value &&
+                                      !std::is_same<T, char>::value>> {
+        static inline PyObject *box(T value) {
+            return py::long_::_box_integer(value);
+        }
+    };
+
+    template<typename T>
+    struct _boxer<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+        static inline PyObject *box(T value) {
+            return PyFloat_FromDouble(value);
+        }
+    };
 
+    /**
+       `std::string` is decoded as UTF-8 into a `str`.
+    */
     template<>
-    constexpr char typeformat<PyObject*> = 'O';
+    struct _boxer<std::string> {
+        static inline PyObject *box(const std::string &value) {
+            return PyUnicode_FromStringAndSize(value.data(), value.size());
+        }
+    };
+
+    /**
+       `std::vector` is boxed into a `list` which is allocated at its final
+       size and filled in place.
+    */
+    template<typename T, typename Alloc>
+    struct _boxer<std::vector<T, Alloc>> {
+        static inline PyObject *box(const std::vector<T, Alloc> &value) {
+            PyObject *out = PyList_New(value.size());
+            if (!out) {
+                return nullptr;
+            }
+
+            Py_ssize_t n = 0;
+            for (const auto &elem : value) {
+                PyObject *item = _boxer<T>::box(elem);
+                if (!item) {
+                    Py_DECREF(out);
+                    return nullptr;
+                }
+                PyList_SET_ITEM(out, n++, item);
+            }
+            return out;
+        }
+    };
+
+    /**
+       `std::tuple` is boxed into a `tuple`.
+    */
+    template<typename... Ts>
+    struct _boxer<std::tuple<Ts...>> {
+        static inline bool set(PyObject *out, std::size_t ix, PyObject *item) {
+            PyTuple_SET_ITEM(out, ix, item);
+            return item;
+        }
+
+        template<std::size_t... Ixs>
+        static inline PyObject *box(const std::tuple<Ts...> &value,
+                                    std::index_sequence<Ixs...>) {
+            PyObject *out = PyTuple_New(sizeof...(Ts));
+            if (!out) {
+                return nullptr;
+            }
+
+            bool ok = true;
+
+            // stop boxing at the first failure so we do not overwrite the
+            // exception, unset items are nullptr which the tuple dealloc
+            // skips
+            (void) std::initializer_list<int> {
+                (ok = ok && set(out,
+                                Ixs,
+                                _boxer<Ts>::box(std::get<Ixs>(value))),
+                 0)...
+            };
+            if (!ok) {
+                Py_DECREF(out);
+                return nullptr;
+            }
+            return out;
+        }
+
+        static inline PyObject *box(const std::tuple<Ts...> &value) {
+            return box(value, std::index_sequence_for<Ts...>{});
+        }
+    };
 
     template<>
-    constexpr char typeformat<py::object> = 'O';
+    struct _boxer<std::tuple<>> {
+        static inline PyObject *box(const std::tuple<>&) {
+            return PyTuple_New(0);
+        }
+    };
+
+#if HAVE_OPTIONAL
+    /**
+       An empty `std::optional` is boxed as `None`.
+    */
+    template<typename T>
+    struct _boxer<std::optional<T>> {
+        static inline PyObject *box(const std::optional<T> &value) {
+            if (!value) {
+                Py_RETURN_NONE;
+            }
+            return _boxer<T>::box(*value);
+        }
+    };
+#endif
+
+    /**
+       Call the wrapped function and box its result. Functions which return
+       `void` return `None`.
+    */
+    template<typename R>
+    struct _invoke_impl {
+        template<typename F, typename... Args>
+        static inline PyObject *call(const F &f, Args&&... args) {
+            return _box(f(std::forward<Args>(args)...));
+        }
+    };
 
     template<>
-    constexpr char typeformat<bool> = 'p';
+    struct _invoke_impl<void> {
+        template<typename F, typename... Args>
+        static inline PyObject *call(const F &f, Args&&... args) {
+            f(std::forward<Args>(args)...);
+            Py_RETURN_NONE;
+        }
+    };
+
+    /**
+       Translate the C++ exception currently being handled into a Python
+       exception. This must be called from inside a `catch` block.
+
+       - `py::error_already_set`: the Python exception is already set.
+       - `pyutils::bad_nonnull`: propagates the Python exception or raises
+         an `AssertionError`, the same as `failed_null_check`.
+       - `std::bad_alloc`: `MemoryError`.
+       - `std::out_of_range`: `IndexError`.
+       - any other `std::exception`: `RuntimeError` with the message from
+         `what()`.
+       - anything else: `SystemError`.
+    */
+    void _translate_exception();
+
+    /**
+       Call the wrapped function with `_invoke_impl`. When `translate` is
+       true C++ exceptions thrown by the function are turned into Python
+       exceptions with `_translate_exception`, otherwise they are not
+       caught.
+    */
+    template<typename R, bool translate>
+    struct _invoke : public _invoke_impl<R> {};
+
+    template<typename R>
+    struct _invoke<R, true> {
+        template<typename F, typename... Args>
+        static inline PyObject *call(const F &f, Args&&... args) {
+            try {
+                return _invoke_impl<R>::call(f, std::forward<Args>(args)...);
+            }
+            catch (...) {
+                _translate_exception();
+                return nullptr;
+            }
+        }
+    };
 
     /**
        Struct for extracting traits about the function being wrapped.
@@ -82,89 +580,812 @@ namespace pyutils {
         static_assert(sizeof(Self) == sizeof(py::object),
                       "self argument is the incorrect size");
         using return_type = R;
-        using parsed_args_type = std::tuple<Args...>;
+        using args_type = std::tuple<Args...>;
+        using parsed_args_type = std::tuple<_argument<Args>...>;
 
         static constexpr std::size_t arity = sizeof...(Args);
-        static constexpr auto flags = arity ? METH_VARARGS : METH_NOARGS;
-
-        static inline auto fmtstr() {
-            return std::array<char, arity + 1> {typeformat<Args>..., '\0'};
-        }
+#if HAVE_METH_FASTCALL
+        static constexpr int flags = arity ? METH_FASTCALL : METH_NOARGS;
+#else
+        static constexpr int flags = arity ? METH_VARARGS : METH_NOARGS;
+#endif
     };
 
+    /**
+       Raise the `TypeError` for calling a function with the wrong number of
+       positional arguments.
+    */
+    void _raise_bad_arity(std::size_t arity, Py_ssize_t nargs);
+
     /**
        Struct which provides a single function `f` which is the actual
-       implementation of `_automethod_wrapper` to use. This is implemented
+       implementation of `_automethodwrapper` to use. This is implemented
        as a struct to allow for partial template specialization to optimize
        for the `METH_NOARGS` case.
     */
-    template<std::size_t arity, typename F, const F &impl>
+    template<std::size_t arity, typename F, const F &impl, bool translate>
     struct _automethodwrapper_impl {
-        static inline PyObject *f(PyObject *self, PyObject *args) {
-            using f = _function_traits<F>;
-            typename f::parsed_args_type parsed_args;
+        using traits = _function_traits<F>;
+
+        template<std::size_t... Ixs>
+        static inline PyObject *call(PyObject *self,
+                                     PyObject *const *args,
+                                     std::index_sequence<Ixs...>) {
+            typename traits::parsed_args_type parsed_args;
+            bool ok = true;
 
-            if (!apply(PyArg_ParseTuple,
-                       std::tuple_cat(std::make_tuple(args, f::fmtstr().data()),
-                                      tuple_refs(parsed_args)))) {
+            // stop converting at the first failure so we do not overwrite
+            // the exception
+            (void) std::initializer_list<int> {
+                (ok = ok && std::get<Ixs>(parsed_args).convert(args[Ixs]),
+                 0)...
+            };
+            if (!ok) {
                 return nullptr;
             }
-            return apply(impl,
-                         std::tuple_cat(std::make_tuple(self), parsed_args));
+            return _invoke<typename traits::return_type, translate>::call(
+                impl,
+                self,
+                std::get<Ixs>(parsed_args).value...);
         }
+
+        static PyObject *fastcall(PyObject *self,
+                                  PyObject *const *args,
+                                  Py_ssize_t nargs) {
+            if (nargs != (Py_ssize_t) arity) {
+                _raise_bad_arity(arity, nargs);
+                return nullptr;
+            }
+            return call(self, args, std::make_index_sequence<arity>{});
+        }
+
+#if HAVE_METH_FASTCALL
+        static PyObject *f(PyObject *self,
+                           PyObject *const *args,
+                           Py_ssize_t nargs) {
+            return fastcall(self, args, nargs);
+        }
+#else
+        static PyObject *f(PyObject *self, PyObject *args) {
+            return fastcall(self,
+                            ((PyTupleObject*) args)->ob_item,
+                            PyTuple_GET_SIZE(args));
+        }
+#endif
     };
 
     /**
        `METH_NOARGS` handler for `_automethodwrapper_impl`, hit when
        `arity == 0`.
     */
-    template<typename F, const F &impl>
-    struct _automethodwrapper_impl<0, F, impl> {
-        static inline PyObject *f(PyObject *self, PyObject *args) {
-            return impl(self);
+    template<typename F, const F &impl, bool translate>
+    struct _automethodwrapper_impl<0, F, impl, translate> {
+        using traits = _function_traits<F>;
+
+        static inline PyObject *call(PyObject *self,
+                                     PyObject *const*,
+                                     std::index_sequence<>) {
+            return _invoke<typename traits::return_type, translate>::call(
+                impl,
+                self);
+        }
+
+        static PyObject *f(PyObject *self, PyObject*) {
+            return call(self, nullptr, std::index_sequence<>{});
         }
     };
 
     /**
        The actual funtion that will be registered with the automatically
-       created PyMethodDef. This has the signature expected for a python
-       function and will handle unpacking the arguments.
+       created PyMethodDef is `_automethodwrapper<F, impl>::f`. This has the
+       signature expected for a python function with the flags in
+       `_function_traits<F>::flags` and will handle unpacking the arguments.
+       Each argument is converted with the `_converter` for its type, which
+       is selected at compile time. When `translate` is true C++ exceptions
+       thrown by `impl` are converted into Python exceptions.
+    */
+    template<typename F, const F &impl, bool translate = false>
+    using _automethodwrapper = _automethodwrapper_impl<
+        _function_traits<F>::arity,
+        F,
+        impl,
+        translate>;
+
+    /**
+       Bind the keyword arguments of a call to the parameter slots of a
+       function wrapped with `automethod_kw`.
+
+       Keys are matched against `names` by identity first, which is the
+       common case because both the caller's keywords and `names` are
+       interned, and then by string comparison.
 
-       @param self The module or instance this is a method of.
-       @param args The arguments to the method as a `PyTupleObject*`.
-       @return     The result of calling our method.
+       @param names    The tuple of parameter names.
+       @param slots    The argument slots, the first `nargs` are filled.
+       @param nargs    The number of positional arguments.
+       @param kwvalues The values for the keywords in `kwnames`.
+       @param kwnames  The tuple of keyword names for this call.
+       @return         false with a Python exception set on failure.
     */
-    template<typename F, const F &impl>
-    PyObject *_automethodwrapper(PyObject *self, PyObject *args) {
-        return _automethodwrapper_impl<_function_traits<F>::arity,
-                                       F,
-                                       impl>::f(self, args);
+    bool _bind_keywords(PyObject *names,
+                        PyObject **slots,
+                        Py_ssize_t nargs,
+                        PyObject *const *kwvalues,
+                        PyObject *kwnames);
+
+    /**
+       Bind the keyword arguments of a `METH_VARARGS | METH_KEYWORDS` call.
+
+       @see _bind_keywords
+    */
+    bool _bind_keywords_dict(PyObject *names,
+                             PyObject **slots,
+                             Py_ssize_t nargs,
+                             PyObject *kwargs);
+
+    /**
+       Raise the `TypeError` for calling a function with more positional
+       arguments than it has parameters.
+    */
+    void _raise_too_many_positional(std::size_t arity, Py_ssize_t nargs);
+
+    /**
+       Raise the `TypeError` for a required parameter with no argument.
+    */
+    void _raise_missing_argument(PyObject *names, std::size_t ix);
+
+    /**
+       Compile time information about a single parameter declaration passed
+       to `automethod_kw`. A bare keyword, `"a"_kw`, declares a required
+       parameter and a keyword bound to a C++ value, `"a"_kw = 1`, declares
+       a parameter with a default.
+    */
+    template<typename Spec>
+    struct _keyword_spec;
+
+    template<char... cs>
+    struct _keyword_spec<py::keyword<cs...>> {
+        using name = py::keyword<cs...>;
+
+        template<typename A>
+        static inline bool fill(const py::keyword<cs...>&,
+                                A&,
+                                PyObject *names,
+                                std::size_t ix) {
+            _raise_missing_argument(names, ix);
+            return false;
+        }
+    };
+
+    template<typename Name, typename T>
+    struct _keyword_spec<py::keyword_default<Name, T>> {
+        using name = Name;
+
+        template<typename A>
+        static inline bool fill(const py::keyword_default<Name, T> &spec,
+                                A &arg,
+                                PyObject*,
+                                std::size_t) {
+            arg.value = spec.value;
+            return true;
+        }
+    };
+
+    /**
+       The function registered for a `PyMethodDef` created with
+       `automethod_kw`. `Tag` is a unique type per use of the macro which
+       owns the storage for the default values in `specs`.
+    */
+    template<typename F,
+             const F &impl,
+             bool translate,
+             typename Tag,
+             typename... Specs>
+    struct _automethodwrapper_kw {
+        using traits = _function_traits<F>;
+        static constexpr std::size_t arity = traits::arity;
+
+        static_assert(arity > 0,
+                      "automethod_kw requires at least one parameter");
+        static_assert(sizeof...(Specs) == arity,
+                      "automethod_kw needs one keyword for each parameter");
+
+        using kwnames = py::_kwnames<typename _keyword_spec<Specs>::name...>;
+
+#if HAVE_METH_FASTCALL
+        static constexpr int flags = METH_FASTCALL | METH_KEYWORDS;
+#else
+        static constexpr int flags = METH_VARARGS | METH_KEYWORDS;
+#endif
+
+        static std::tuple<Specs...> specs;
+
+        template<std::size_t... Ixs>
+        static inline PyObject *call(PyObject *self,
+                                     PyObject *names,
+                                     PyObject **slots,
+                                     std::index_sequence<Ixs...>) {
+            typename traits::parsed_args_type parsed_args;
+            bool ok = true;
+
+            (void) std::initializer_list<int> {
+                (ok = ok && (slots[Ixs] ?
+                             std::get<Ixs>(parsed_args).convert(slots[Ixs]) :
+                             _keyword_spec<
+                                 std::tuple_element_t<
+                                     Ixs,
+                                     std::tuple<Specs...>>>::fill(
+                                         std::get<Ixs>(specs),
+                                         std::get<Ixs>(parsed_args),
+                                         names,
+                                         Ixs)),
+                 0)...
+            };
+            if (!ok) {
+                return nullptr;
+            }
+            return _invoke<typename traits::return_type, translate>::call(
+                impl,
+                self,
+                std::get<Ixs>(parsed_args).value...);
+        }
+
+#if HAVE_METH_FASTCALL
+        static PyObject *f(PyObject *self,
+                           PyObject *const *args,
+                           Py_ssize_t nargs,
+                           PyObject *kwnames_in) {
+            if (nargs > (Py_ssize_t) arity) {
+                _raise_too_many_positional(arity, nargs);
+                return nullptr;
+            }
+
+            PyObject *names = kwnames::get();
+            if (!names) {
+                return nullptr;
+            }
+
+            PyObject *slots[arity] = {};
+            for (Py_ssize_t n = 0; n < nargs; ++n) {
+                slots[n] = args[n];
+            }
+            if (kwnames_in &&
+                !_bind_keywords(names, slots, nargs, args + nargs, kwnames_in)) {
+                return nullptr;
+            }
+            return call(self, names, slots, std::make_index_sequence<arity>{});
+        }
+#else
+        static PyObject *f(PyObject *self, PyObject *args, PyObject *kwargs) {
+            Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+            if (nargs > (Py_ssize_t) arity) {
+                _raise_too_many_positional(arity, nargs);
+                return nullptr;
+            }
+
+            PyObject *names = kwnames::get();
+            if (!names) {
+                return nullptr;
+            }
+
+            PyObject *slots[arity] = {};
+            for (Py_ssize_t n = 0; n < nargs; ++n) {
+                slots[n] = PyTuple_GET_ITEM(args, n);
+            }
+            if (kwargs && !_bind_keywords_dict(names, slots, nargs, kwargs)) {
+                return nullptr;
+            }
+            return call(self, names, slots, std::make_index_sequence<arity>{});
+        }
+#endif
+    };
+
+    template<typename F,
+             const F &impl,
+             bool translate,
+             typename Tag,
+             typename... Specs>
+    std::tuple<Specs...>
+    _automethodwrapper_kw<F, impl, translate, Tag, Specs...>::specs;
+
+    /**
+       Store the parameter declarations for an `automethod_kw` and build its
+       `PyMethodDef`.
+    */
+    template<typename F,
+             const F &impl,
+             bool translate,
+             typename Tag,
+             typename... Specs>
+    PyMethodDef _make_automethod_kw(const char *name,
+                                    const char *doc,
+                                    const Specs&... specs) {
+        using wrapper = _automethodwrapper_kw<F,
+                                              impl,
+                                              translate,
+                                              Tag,
+                                              Specs...>;
+
+        wrapper::specs = std::make_tuple(specs...);
+        return PyMethodDef {
+            name,
+            (PyCFunction) (void(*)(void)) wrapper::f,
+            wrapper::flags,
+            doc,
+        };
     }
 
-#define _libpy_automethod_def(name, f, doc)  (PyMethodDef {             \
+    /**
+       Type checks used to pick an overload in `automethod_overloads`.
+
+       Each type check provides:
+       `template<bool exact> static bool check(PyObject *ob)`. The exact
+       check only accepts the builtin type the converter is designed for
+       and the loose check also accepts subclasses.
+    */
+    template<typename T, typename = void>
+    struct _type_check;
+
+    template<typename T>
+    struct _type_check<T, std::enable_if_t<std::is_integral<T>::value &&
+                                           !std::is_same<T, bool>::value &&
+                                           !std::is_same<T, char>::value>> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return exact ? PyLong_CheckExact(ob) : PyLong_Check(ob);
+        }
+    };
+
+    template<>
+    struct _type_check<bool> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return PyBool_Check(ob);
+        }
+    };
+
+    template<>
+    struct _type_check<char> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return exact ?
+                PyBytes_CheckExact(ob) :
+                PyBytes_Check(ob) || PyByteArray_Check(ob);
+        }
+    };
+
+    template<typename T>
+    struct _type_check<T,
+                       std::enable_if_t<std::is_floating_point<T>::value>> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return exact ? PyFloat_CheckExact(ob) : PyFloat_Check(ob);
+        }
+    };
+
+    template<>
+    struct _type_check<Py_complex> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return exact ? PyComplex_CheckExact(ob) : PyComplex_Check(ob);
+        }
+    };
+
+    template<>
+    struct _type_check<const char*> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return ob == Py_None ||
+                (exact ? PyUnicode_CheckExact(ob) : PyUnicode_Check(ob));
+        }
+    };
+
+    template<>
+    struct _type_check<Py_buffer> {
+        template<bool exact>
+        static inline bool check(PyObject *ob) {
+            return PyObject_CheckBuffer(ob);
+        }
+    };
+
+    template<typename T>
+    struct _type_check<T,
+                       std::enable_if_t<std::is_same<T, PyObject*>::value ||
+                                        std::is_same<T, py::object>::value>> {
+        template<bool exact>
+        static inline bool check(PyObject*) {
+            return true;
+        }
+    };
+
+    /**
+       A single overload registered with `automethod_overloads`.
+    */
+    template<typename F, const F &impl>
+    struct _overload {
+        using traits = _function_traits<F>;
+        static constexpr std::size_t arity = traits::arity;
+
+        template<bool exact, std::size_t... Ixs>
+        static inline bool match(PyObject *const *args,
+                                 std::index_sequence<Ixs...>) {
+            bool ok = true;
+
+            (void) args;
+            (void) std::initializer_list<int> {
+                (ok = ok && _type_check<
+                     std::tuple_element_t<Ixs, typename traits::args_type>
+                 >::template check<exact>(args[Ixs]),
+                 0)...
+            };
+            return ok;
+        }
+
+        static inline PyObject *call(PyObject *self, PyObject *const *args) {
+            return _automethodwrapper_impl<arity, F, impl, false>::call(
+                self,
+                args,
+                std::make_index_sequence<arity>{});
+        }
+    };
+
+    /**
+       Pick the first overload in `Overloads` whose arity is `nargs` and
+       whose parameter types pass the `exact` type checks. The arity of each
+       overload is known at compile time so the `nargs` tests fold into a
+       branch per overload before any type is checked.
+    */
+    template<bool exact, typename... Overloads>
+    struct _overload_pass {
+        static inline bool dispatch(PyObject*,
+                                    PyObject *const*,
+                                    Py_ssize_t,
+                                    PyObject*&) {
+            return false;
+        }
+    };
+
+    template<bool exact, typename Overload, typename... Overloads>
+    struct _overload_pass<exact, Overload, Overloads...> {
+        static inline bool dispatch(PyObject *self,
+                                    PyObject *const *args,
+                                    Py_ssize_t nargs,
+                                    PyObject *&out) {
+            if (nargs == (Py_ssize_t) Overload::arity &&
+                Overload::template match<exact>(
+                    args,
+                    std::make_index_sequence<Overload::arity>{})) {
+                out = Overload::call(self, args);
+                return true;
+            }
+            return _overload_pass<exact, Overloads...>::dispatch(self,
+                                                                 args,
+                                                                 nargs,
+                                                                 out);
+        }
+    };
+
+    /**
+       Raise the `TypeError` for a call which matches none of the overloads
+       of a function.
+    */
+    void _raise_no_overload(PyObject *const *args, Py_ssize_t nargs);
+
+    /**
+       The function registered for a `PyMethodDef` created with
+       `automethod_overloads`.
+
+       Exact type matches are tried first so that, for example, an `int`
+       argument picks a `long` overload over a `double` overload no matter
+       the order they are registered in. If no overload matches exactly then
+       subclasses of the parameter types are accepted. Only the overload
+       which is picked converts its arguments.
+    */
+    template<typename... Overloads>
+    struct _automethodoverloads {
+        static_assert(sizeof...(Overloads) > 0,
+                      "automethod_overloads needs at least one overload");
+
+#if HAVE_METH_FASTCALL
+        static constexpr int flags = METH_FASTCALL;
+#else
+        static constexpr int flags = METH_VARARGS;
+#endif
+
+        static inline PyObject *fastcall(PyObject *self,
+                                         PyObject *const *args,
+                                         Py_ssize_t nargs) {
+            PyObject *out;
+
+            if (_overload_pass<true, Overloads...>::dispatch(self,
+                                                             args,
+                                                             nargs,
+                                                             out) ||
+                _overload_pass<false, Overloads...>::dispatch(self,
+                                                              args,
+                                                              nargs,
+                                                              out)) {
+                return out;
+            }
+            _raise_no_overload(args, nargs);
+            return nullptr;
+        }
+
+#if HAVE_METH_FASTCALL
+        static PyObject *f(PyObject *self,
+                           PyObject *const *args,
+                           Py_ssize_t nargs) {
+            return fastcall(self, args, nargs);
+        }
+#else
+        static PyObject *f(PyObject *self, PyObject *args) {
+            return fastcall(self,
+                            ((PyTupleObject*) args)->ob_item,
+                            PyTuple_GET_SIZE(args));
+        }
+#endif
+    };
+
+    /**
+       Release the GIL for the lifetime of this object.
+    */
+    class _release_gil {
+    private:
+        PyThreadState *state;
+
+    public:
+        _release_gil() : state(PyEval_SaveThread()) {}
+        _release_gil(const _release_gil&) = delete;
+        _release_gil &operator=(const _release_gil&) = delete;
+
+        ~_release_gil() {
+            PyEval_RestoreThread(state);
+        }
+    };
+
+    /**
+       Check if all of the given booleans are true.
+    */
+    template<bool... bs>
+    using _all_of = std::is_same<std::integer_sequence<bool, true, bs...>,
+                                 std::integer_sequence<bool, bs..., true>>;
+
+    template<typename T>
+    struct _is_python_object;
+
+    /**
+       Implementation of `_is_python_object` for a type without cv or
+       reference qualifiers. The standard containers are checked by their
+       element types.
+    */
+    template<typename T>
+    struct _holds_python_object {
+        static constexpr bool value =
+            std::is_base_of<py::object, T>::value ||
+            std::is_convertible<T, const PyObject*>::value;
+    };
+
+    template<typename T, typename Alloc>
+    struct _holds_python_object<std::vector<T, Alloc>> {
+        static constexpr bool value = _is_python_object<T>::value;
+    };
+
+    template<typename T, std::size_t n>
+    struct _holds_python_object<std::array<T, n>> {
+        static constexpr bool value = _is_python_object<T>::value;
+    };
+
+    template<typename... Ts>
+    struct _holds_python_object<std::tuple<Ts...>> {
+        static constexpr bool value =
+            !_all_of<!_is_python_object<Ts>::value...>::value;
+    };
+
+    template<typename T, typename U>
+    struct _holds_python_object<std::pair<T, U>> {
+        static constexpr bool value =
+            _is_python_object<T>::value || _is_python_object<U>::value;
+    };
+
+#if HAVE_OPTIONAL
+    template<typename T>
+    struct _holds_python_object<std::optional<T>> {
+        static constexpr bool value = _is_python_object<T>::value;
+    };
+#endif
+
+    /**
+       Check if a type gives access to Python objects, which may not be
+       used without holding the GIL. This includes the standard containers
+       of Python objects, like `std::vector<py::object>` or
+       `std::tuple<int, PyObject*>`.
+    */
+    template<typename T>
+    struct _is_python_object {
+        static constexpr bool value = _holds_python_object<
+            std::remove_cv_t<std::remove_reference_t<T>>>::value;
+    };
+
+    /**
+       Struct for extracting traits about a function wrapped with
+       `automethod_nogil`. These functions do not take `self` and may only
+       accept and return C++ values.
+    */
+    template<typename F>
+    struct _nogil_function_traits;
+
+    template<typename R, typename... Args>
+    struct _nogil_function_traits<R(Args...)> {
+        static_assert(!_is_python_object<R>::value,
+                      "automethod_nogil functions cannot return Python "
+                      "objects");
+        static_assert(_all_of<!_is_python_object<Args>::value...>::value,
+                      "automethod_nogil functions cannot take Python objects");
+
+        using return_type = R;
+        using parsed_args_type = std::tuple<_argument<Args>...>;
+
+        static constexpr std::size_t arity = sizeof...(Args);
+#if HAVE_METH_FASTCALL
+        static constexpr int flags = METH_FASTCALL;
+#else
+        static constexpr int flags = METH_VARARGS;
+#endif
+    };
+
+    /**
+       Function object which calls `impl` with the GIL released.
+    */
+    template<typename F, const F &impl>
+    struct _without_gil {
+        template<typename... Args>
+        inline decltype(auto) operator()(PyObject*, Args&&... args) const {
+            _release_gil released;
+            return impl(std::forward<Args>(args)...);
+        }
+    };
+
+    /**
+       The function registered for a `PyMethodDef` created with
+       `automethod_nogil`.
+
+       The arguments are converted while holding the GIL, the GIL is
+       released to run `impl`, and it is reacquired before the result is
+       boxed. `impl` can only report errors by throwing so C++ exceptions
+       are always translated.
+    */
+    template<typename F, const F &impl>
+    struct _automethodwrapper_nogil {
+        using traits = _nogil_function_traits<F>;
+        static constexpr std::size_t arity = traits::arity;
+
+        template<std::size_t... Ixs>
+        static inline PyObject *call(PyObject *self,
+                                     PyObject *const *args,
+                                     std::index_sequence<Ixs...>) {
+            typename traits::parsed_args_type parsed_args;
+            bool ok = true;
+
+            (void) args;
+            (void) std::initializer_list<int> {
+                (ok = ok && std::get<Ixs>(parsed_args).convert(args[Ixs]),
+                 0)...
+            };
+            if (!ok) {
+                return nullptr;
+            }
+            return _invoke<typename traits::return_type, true>::call(
+                _without_gil<F, impl>{},
+                self,
+                std::get<Ixs>(parsed_args).value...);
+        }
+
+        static PyObject *fastcall(PyObject *self,
+                                  PyObject *const *args,
+                                  Py_ssize_t nargs) {
+            if (nargs != (Py_ssize_t) arity) {
+                _raise_bad_arity(arity, nargs);
+                return nullptr;
+            }
+            return call(self, args, std::make_index_sequence<arity>{});
+        }
+
+#if HAVE_METH_FASTCALL
+        static PyObject *f(PyObject *self,
+                           PyObject *const *args,
+                           Py_ssize_t nargs) {
+            return fastcall(self, args, nargs);
+        }
+#else
+        static PyObject *f(PyObject *self, PyObject *args) {
+            return fastcall(self,
+                            ((PyTupleObject*) args)->ob_item,
+                            PyTuple_GET_SIZE(args));
+        }
+#endif
+    };
+
+#define _libpy_automethod_nogil_def(name, func, doc)  (PyMethodDef {    \
         name,                                                           \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        pyutils::_function_traits<decltype(f)>::flags,                  \
+        (PyCFunction) (void(*)(void))                                   \
+        pyutils::_automethodwrapper_nogil<decltype(func), func>::f,     \
+        pyutils::_nogil_function_traits<decltype(func)>::flags,         \
         doc,                                                            \
     })
 
-#define _libpy_automethod_2(f, doc) (PyMethodDef {                      \
-        #f,                                                             \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        pyutils::_function_traits<decltype(f)>::flags,                  \
+#define _libpy_automethod_nogil_2(f, doc)       \
+    _libpy_automethod_nogil_def(#f, f, doc)
+#define _libpy_automethod_nogil_1(f) _libpy_automethod_nogil_2(f, nullptr)
+#define _libpy_named_automethod_nogil_3(name, f, doc)   \
+    _libpy_automethod_nogil_def(name, f, doc)
+#define _libpy_named_automethod_nogil_2(name, f)        \
+    _libpy_named_automethod_nogil_3(name, f, nullptr)
+
+#define _libpy_overload(f) pyutils::_overload<decltype(f), f>
+#define _libpy_overloads_1(a) _libpy_overload(a)
+#define _libpy_overloads_2(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_1(__VA_ARGS__)
+#define _libpy_overloads_3(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_2(__VA_ARGS__)
+#define _libpy_overloads_4(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_3(__VA_ARGS__)
+#define _libpy_overloads_5(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_4(__VA_ARGS__)
+#define _libpy_overloads_6(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_5(__VA_ARGS__)
+#define _libpy_overloads_7(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_6(__VA_ARGS__)
+#define _libpy_overloads_8(a, ...)                              \
+    _libpy_overload(a), _libpy_overloads_7(__VA_ARGS__)
+#define _libpy_overloads_dispatch(_1, _2, _3, _4, _5, _6, _7, _8, macro, ...) \
+    macro
+#define _libpy_overloads(...)                                           \
+    _libpy_overloads_dispatch(__VA_ARGS__,                              \
+                              _libpy_overloads_8,                       \
+                              _libpy_overloads_7,                       \
+                              _libpy_overloads_6,                       \
+                              _libpy_overloads_5,                       \
+                              _libpy_overloads_4,                       \
+                              _libpy_overloads_3,                       \
+                              _libpy_overloads_2,                       \
+                              _libpy_overloads_1)(__VA_ARGS__)
+
+#define _libpy_automethod_kw_def(name, func, doc, translate, ...)       \
+    ([] {                                                               \
+        using py::operator""_kw;                                        \
+        struct tag {};                                                  \
+        return pyutils::_make_automethod_kw<decltype(func),             \
+                                            func,                       \
+                                            translate,                  \
+                                            tag>(                       \
+            name,                                                       \
+            doc,                                                        \
+            __VA_ARGS__);                                               \
+    }())
+
+#define _libpy_automethod_def(name, func, doc, translate)  (PyMethodDef { \
+        name,                                                           \
+        (PyCFunction) (void(*)(void))                                   \
+        pyutils::_automethodwrapper<decltype(func), func, translate>::f, \
+        pyutils::_function_traits<decltype(func)>::flags,               \
         doc,                                                            \
     })
+
+#define _libpy_automethod_2(f, doc) _libpy_automethod_def(#f, f, doc, false)
 #define _libpy_automethod_1(f) _libpy_automethod_2(f, nullptr)
+#define _libpy_automethod_except_2(f, doc)      \
+    _libpy_automethod_def(#f, f, doc, true)
+#define _libpy_automethod_except_1(f) _libpy_automethod_except_2(f, nullptr)
 #define _libpy_automethod_dispatch(n, f, doc, macro, ...)  macro
 
-#define _libpy_named_automethod_3(name, f, doc) (PyMethodDef {          \
-        name,                                                           \
-        (PyCFunction) pyutils::_automethodwrapper<decltype(f), f>,      \
-        METH_VARARGS,                                                   \
-        doc,                                                            \
-    })
-#define _libpy_named_automethod_2(name, f) _libpy_automethod_2(name, f, nullptr)
-#define _libpy_named_automethod_dispatch(n, f, doc, macro, ...)  macro
+#define _libpy_named_automethod_3(name, f, doc)         \
+    _libpy_automethod_def(name, f, doc, false)
+#define _libpy_named_automethod_2(name, f)              \
+    _libpy_named_automethod_3(name, f, nullptr)
+#define _libpy_named_automethod_except_3(name, f, doc)  \
+    _libpy_automethod_def(name, f, doc, true)
+#define _libpy_named_automethod_except_2(name, f)       \
+    _libpy_named_automethod_except_3(name, f, nullptr)
+#define _libpy_named_automethod_dispatch(name, f, doc, macro, ...)  macro
 
     /**
        Wrap a C++ function as a python `PyMethodDef` structure.
@@ -193,7 +1414,144 @@ namespace pyutils {
        @return     A `PyMethodDef` structure for the given function.
     */
 #define named_automethod(...)                                           \
-    _libpy_named_automethod_dispatch(name,##__VA_ARGS__,                \
-                                     _libpy_named_automethod_3(__VA_ARGS__),  \
-                                     _libpy_named_automethod_3(__VA_ARGS__))
+    _libpy_named_automethod_dispatch(__VA_ARGS__,                       \
+                                     _libpy_named_automethod_3(__VA_ARGS__), \
+                                     _libpy_named_automethod_2(__VA_ARGS__))
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure which
+       accepts keyword arguments.
+
+       Each parameter is declared with a `_kw` literal, optionally bound to a
+       default value, for example:
+       `automethod_kw(f, nullptr, "a"_kw, "b"_kw = 1.5)`. The names are
+       interned once and defaults are stored in the wrapper so calls do not
+       allocate to bind arguments.
+
+       @param func The function to wrap.
+       @param doc  The docstring to use for the function or nullptr.
+       @param ...  One keyword declaration for each parameter after `self`.
+       @return     A `PyMethodDef` structure for the given function.
+    */
+#define automethod_kw(func, doc, ...)                                   \
+    _libpy_automethod_kw_def(#func, func, doc, false, __VA_ARGS__)
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure which
+       accepts keyword arguments and give the python function an explicit
+       name.
+
+       @see automethod_kw
+       @param name The name for the function as it will be seen from python.
+    */
+#define named_automethod_kw(name, func, doc, ...)                       \
+    _libpy_automethod_kw_def(name, func, doc, false, __VA_ARGS__)
+
+    /**
+       Wrap up to 8 C++ functions as a single python `PyMethodDef`
+       structure which dispatches to the overload that matches the types of
+       the arguments.
+
+       The overload is picked by the number of arguments and then by exact
+       type checks, for example `int` for integer parameters, `float` for
+       floating point parameters and `str` for `const char*` parameters.
+
+       @param name The name for the function as it will be seen from python.
+       @param doc  The docstring to use for the function or nullptr.
+       @param ...  The functions to dispatch between, in priority order.
+       @return     A `PyMethodDef` structure for the given functions.
+    */
+#define automethod_overloads(name, doc, ...)  (PyMethodDef {            \
+        name,                                                           \
+        (PyCFunction) (void(*)(void))                                   \
+        pyutils::_automethodoverloads<_libpy_overloads(__VA_ARGS__)>::f, \
+        pyutils::_automethodoverloads<                                  \
+            _libpy_overloads(__VA_ARGS__)>::flags,                      \
+        doc,                                                            \
+    })
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure like
+       `automethod` but translate C++ exceptions thrown by the function into
+       Python exceptions instead of letting them escape into the
+       interpreter.
+
+       This lets the function throw, for example with
+       `py::object::as_nonnull` or `py::error_already_set`, instead of
+       checking for null after each operation.
+
+       @see automethod
+       @see pyutils::_translate_exception
+    */
+#define automethod_except(...)                                          \
+    _libpy_automethod_dispatch(,##__VA_ARGS__,                          \
+                               _libpy_automethod_except_2(__VA_ARGS__), \
+                               _libpy_automethod_except_1(__VA_ARGS__))
+
+    /**
+       `named_automethod` which translates C++ exceptions.
+
+       @see automethod_except
+       @see named_automethod
+    */
+#define named_automethod_except(...)                                    \
+    _libpy_named_automethod_dispatch(                                   \
+        __VA_ARGS__,                                                    \
+        _libpy_named_automethod_except_3(__VA_ARGS__),                  \
+        _libpy_named_automethod_except_2(__VA_ARGS__))
+
+    /**
+       `automethod_kw` which translates C++ exceptions.
+
+       @see automethod_except
+       @see automethod_kw
+    */
+#define automethod_kw_except(func, doc, ...)                            \
+    _libpy_automethod_kw_def(#func, func, doc, true, __VA_ARGS__)
+
+    /**
+       `named_automethod_kw` which translates C++ exceptions.
+
+       @see automethod_except
+       @see named_automethod_kw
+    */
+#define named_automethod_kw_except(name, func, doc, ...)                \
+    _libpy_automethod_kw_def(name, func, doc, true, __VA_ARGS__)
+
+    /**
+       Wrap a C++ function as a python `PyMethodDef` structure which runs
+       with the GIL released.
+
+       The function does not take `self` and may only take and return C++
+       values, this is checked at compile time. The arguments are converted
+       and the result is boxed while holding the GIL. Because the function
+       cannot set a Python exception, C++ exceptions are translated like
+       `automethod_except`.
+
+       `const char*` and `Py_buffer` arguments point into memory owned by
+       the argument objects which are kept alive for the duration of the
+       call, but the function must not assume that the memory is not
+       mutated by other threads.
+
+       @param func The function to wrap.
+       @param doc  The docstring to use for the function. If this is omitted
+                   the docstring will be `None`.
+       @return     A `PyMethodDef` structure for the given function.
+    */
+#define automethod_nogil(...)                                           \
+    _libpy_automethod_dispatch(,##__VA_ARGS__,                          \
+                               _libpy_automethod_nogil_2(__VA_ARGS__),  \
+                               _libpy_automethod_nogil_1(__VA_ARGS__))
+
+    /**
+       `named_automethod` which runs with the GIL released.
+
+       @see automethod_nogil
+       @see named_automethod
+    */
+#define named_automethod_nogil(...)                                     \
+    _libpy_named_automethod_dispatch(                                   \
+        __VA_ARGS__,                                                    \
+        _libpy_named_automethod_nogil_3(__VA_ARGS__),                   \
+        _libpy_named_automethod_nogil_2(__VA_ARGS__))
 }
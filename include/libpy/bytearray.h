@@ -0,0 +1,196 @@
+#pragma once
+
+#include "libpy/object.h"
+#include "libpy/span.h"
+#include "libpy/type.h"
+
+namespace py {
+    namespace bytearray {
+        /**
+           A subclass of `py::object` for optional `bytearray` objects.
+        */
+        class object : public py::object {
+        private:
+            /**
+               Function called to verify that `ob` is a bytearray and
+               correctly raise a python exception otherwise.
+            */
+            void bytearray_check();
+
+        public:
+            friend class py::tmpref<object>;
+            friend class py::getitem_result<object>;
+
+            /**
+               Default constructor. This will set `ob` to nullptr.
+            */
+            object();
+
+            /**
+               Constructor from a buffer of bytes. This copies the bytes
+               into a new `bytearray` object.
+            */
+            explicit object(span<const char> data);
+
+            /**
+               Constructor from `PyObject*`. If `pob` is not a `bytearray` then
+               `ob` will be set to `nullptr`.
+            */
+            object(PyObject *pob);
+
+            /**
+               Constructor from `py::object`. If `pob` is not a `bytearray` then
+               `ob` will be set to `nullptr`.
+            */
+            object(const py::object &pob);
+
+            object(const object &cpfrom);
+            object(object &&mvfrom) noexcept;
+
+            using py::object::operator=;
+
+            /**
+               Get the length of the object.
+
+               This is equivalent to `len(this)`.
+
+               @return The length of the object or -1 if an exception occured.
+            */
+            py::ssize_t len() const;
+
+            /**
+               View the contents of the object without copying. The bytes
+               may be modified through the view.
+
+               The view is valid until the object is resized or destroyed.
+
+               @return The bytes of the object. If an exception occured the
+                       view's `data()` is nullptr.
+            */
+            span<char> as_span() const;
+
+            /**
+               Resize the object. New bytes are uninitialized.
+
+               @param size The new length.
+               @return     0 on success or -1 if an exception occured.
+            */
+            int resize(py::ssize_t size);
+
+            /**
+               Coerce to a `nonnull` object.
+
+               @see nonnull
+               @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+               @return this converted to a `nonnull` object.
+            */
+            nonnull<object> as_nonnull() const;
+
+            /**
+               Create a temporary reference. This is a reference that will
+               decref the object when it is destroyed.
+
+               @return this converted into a tmpref.
+            */
+            tmpref<object> as_tmpref() &&;
+        };
+
+        /**
+           The type of Python `bytearray` objects.
+
+           This is equivalent to: `bytearray`.
+        */
+        extern const type::object<bytearray::object> type;
+
+        /**
+           Check if an object is an instance of `bytearray`.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `bytearray`, 0 if `ob` is not an
+                    instance of `bytearray`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int check(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyByteArray_Check((PyObject*) t);
+        }
+
+        inline int check(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Check if an object is an instance of `bytearray` but not a subclass.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `bytearray`, 0 if `ob` is not an
+                    instance of `bytearray`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int checkexact(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyByteArray_CheckExact((PyObject*) t);
+        }
+
+        inline int checkexact(const nonnull<object>&) {
+            return 1;
+        }
+    }
+
+    /**
+       A `py::bytearray::object` where `ob` is known to be nonnull.
+       This is used to skip null checks for performance.
+
+       This class should be used where users want to trade the ability to
+       write a nested expression for perfomance.
+    */
+    template<>
+    class nonnull<bytearray::object> : public bytearray::object {
+    protected:
+        nonnull() = delete;
+        explicit nonnull(PyObject *ob) : bytearray::object(ob) {}
+
+    public:
+        friend class bytearray::object;
+
+        nonnull(const nonnull &cpfrom) : bytearray::object(cpfrom) {}
+        nonnull(nonnull &&mvfrom) noexcept :
+            bytearray::object((PyObject*) mvfrom) {
+            mvfrom.ob = nullptr;
+        }
+
+        nonnull &operator=(const nonnull &cpfrom) {
+            nonnull<bytearray::object> tmp(cpfrom);
+            return (*this = std::move(tmp));
+        }
+
+        nonnull &operator=(nonnull &&mvfrom) noexcept {
+            ob = mvfrom.ob;
+            mvfrom.ob = nullptr;
+            return *this;
+        }
+
+        /**
+           Get the length of the object.
+
+           This is equivalent to `len(this)`.
+        */
+        py::ssize_t len() const {
+            return PyByteArray_GET_SIZE(ob);
+        }
+
+        /**
+           View the contents of the object without copying.
+        */
+        span<char> as_span() const {
+            return {PyByteArray_AS_STRING(ob),
+                    static_cast<std::size_t>(PyByteArray_GET_SIZE(ob))};
+        }
+    };
+}
@@ -0,0 +1,305 @@
+#pragma once
+#include <cstring>
+
+#include "libpy/object.h"
+#include "libpy/span.h"
+#include "libpy/type.h"
+
+namespace py {
+    namespace bytes {
+        /**
+           A subclass of `py::object` for optional `bytes` objects.
+        */
+        class object : public py::object {
+        private:
+            /**
+               Function called to verify that `ob` is a bytes object and
+               correctly raise a python exception otherwise.
+            */
+            void bytes_check();
+
+        public:
+            friend class py::tmpref<object>;
+            friend class py::getitem_result<object>;
+
+            /**
+               Default constructor. This will set `ob` to nullptr.
+            */
+            object();
+
+            /**
+               Constructor from a buffer of bytes. This copies the bytes
+               into a new `bytes` object.
+            */
+            explicit object(span<const char> data);
+
+            /**
+               Constructor from `PyObject*`. If `pob` is not a `bytes` then
+               `ob` will be set to `nullptr`.
+            */
+            object(PyObject *pob);
+
+            /**
+               Constructor from `py::object`. If `pob` is not a `bytes` then
+               `ob` will be set to `nullptr`.
+            */
+            object(const py::object &pob);
+
+            object(const object &cpfrom);
+            object(object &&mvfrom) noexcept;
+
+            using py::object::operator=;
+
+            /**
+               Get the length of the object.
+
+               This is equivalent to `len(this)`.
+
+               @return The length of the object or -1 if an exception occured.
+            */
+            py::ssize_t len() const;
+
+            /**
+               View the contents of the object without copying.
+
+               The view is valid for as long as the object is alive.
+
+               @return The bytes of the object. If an exception occured the
+                       view's `data()` is nullptr.
+            */
+            span<const char> as_span() const;
+
+            /**
+               Coerce to a `nonnull` object.
+
+               @see nonnull
+               @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+               @return this converted to a `nonnull` object.
+            */
+            nonnull<object> as_nonnull() const;
+
+            /**
+               Create a temporary reference. This is a reference that will
+               decref the object when it is destroyed.
+
+               @return this converted into a tmpref.
+            */
+            tmpref<object> as_tmpref() &&;
+        };
+
+        /**
+           The type of Python `bytes` objects.
+
+           This is equivalent to: `bytes`.
+        */
+        extern const type::object<bytes::object> type;
+
+        /**
+           Check if an object is an instance of `bytes`.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `bytes`, 0 if `ob` is not an
+                    instance of `bytes`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int check(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyBytes_Check((PyObject*) t);
+        }
+
+        inline int check(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Check if an object is an instance of `bytes` but not a subclass.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `bytes`, 0 if `ob` is not an
+                    instance of `bytes`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int checkexact(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyBytes_CheckExact((PyObject*) t);
+        }
+
+        inline int checkexact(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Build a `bytes` object in place.
+
+           The writer owns the only reference to a `bytes` object which it
+           appends into directly, growing it geometrically with
+           `_PyBytes_Resize`. Because nothing else can see the object while
+           it is being written, `finish` hands it back after shrinking it to
+           the written length, without a final copy.
+
+           @code
+           py::bytes::writer w;
+           w.write(header).write(body);
+           auto payload = w.finish();
+           @endcode
+
+           Errors do not need to be checked between calls. The first failure
+           is remembered and `finish` returns nullptr with the Python
+           exception set.
+        */
+        class writer {
+        private:
+            PyObject *ob;
+            py::ssize_t size;
+            bool failed;
+
+            /**
+               Grow the buffer so that at least `n` more bytes fit.
+
+               @return true on success, false with a Python exception set.
+            */
+            bool grow(py::ssize_t n);
+
+            /**
+               Check if `n` more bytes fit without growing. This is false
+               after a failure because `ob` is cleared.
+            */
+            bool fits(py::ssize_t n) const {
+                return ob && PyBytes_GET_SIZE(ob) - size >= n;
+            }
+
+            writer &write_slow(const char *data, py::ssize_t n);
+
+        public:
+            /**
+               Create a writer.
+
+               @param capacity The number of bytes to allocate up front.
+            */
+            explicit writer(py::ssize_t capacity = 256);
+            writer(const writer&) = delete;
+            writer &operator=(const writer&) = delete;
+            ~writer();
+
+            /**
+               Append bytes.
+            */
+            writer &write(const char *data, py::ssize_t n) {
+                if (!fits(n)) {
+                    return write_slow(data, n);
+                }
+                std::memcpy(PyBytes_AS_STRING(ob) + size, data, n);
+                size += n;
+                return *this;
+            }
+
+            writer &write(span<const char> data) {
+                return write(data.data(), data.size());
+            }
+
+            writer &write(char c) {
+                return write(&c, 1);
+            }
+
+            /**
+               Get a pointer to at least `n` writable bytes at the end of the
+               buffer. After filling them call `commit` with the number of
+               bytes actually written.
+
+               @return A pointer to the free space or nullptr if an exception
+                       occured.
+            */
+            char *reserve(py::ssize_t n) {
+                if (!(fits(n) || grow(n))) {
+                    return nullptr;
+                }
+                return PyBytes_AS_STRING(ob) + size;
+            }
+
+            /**
+               Mark `n` bytes from the last `reserve` as written.
+            */
+            writer &commit(py::ssize_t n);
+
+            /**
+               The number of bytes written so far.
+            */
+            py::ssize_t len() const {
+                return size;
+            }
+
+            /**
+               The number of bytes that fit before the buffer must grow.
+            */
+            py::ssize_t capacity() const {
+                return ob ? PyBytes_GET_SIZE(ob) : 0;
+            }
+
+            /**
+               Give up ownership of the written `bytes` object. The writer is
+               empty afterwards and will allocate again if it is reused.
+
+               @return The bytes that were written or nullptr if any write
+                       failed.
+            */
+            tmpref<object> finish();
+        };
+    }
+
+    /**
+       A `py::bytes::object` where `ob` is known to be nonnull.
+       This is used to skip null checks for performance.
+
+       This class should be used where users want to trade the ability to
+       write a nested expression for perfomance.
+    */
+    template<>
+    class nonnull<bytes::object> : public bytes::object {
+    protected:
+        nonnull() = delete;
+        explicit nonnull(PyObject *ob) : bytes::object(ob) {}
+
+    public:
+        friend class bytes::object;
+
+        nonnull(const nonnull &cpfrom) : bytes::object(cpfrom) {}
+        nonnull(nonnull &&mvfrom) noexcept :
+            bytes::object((PyObject*) mvfrom) {
+            mvfrom.ob = nullptr;
+        }
+
+        nonnull &operator=(const nonnull &cpfrom) {
+            nonnull<bytes::object> tmp(cpfrom);
+            return (*this = std::move(tmp));
+        }
+
+        nonnull &operator=(nonnull &&mvfrom) noexcept {
+            ob = mvfrom.ob;
+            mvfrom.ob = nullptr;
+            return *this;
+        }
+
+        /**
+           Get the length of the object.
+
+           This is equivalent to `len(this)`.
+        */
+        py::ssize_t len() const {
+            return PyBytes_GET_SIZE(ob);
+        }
+
+        /**
+           View the contents of the object without copying.
+        */
+        span<const char> as_span() const {
+            return {PyBytes_AS_STRING(ob),
+                    static_cast<std::size_t>(PyBytes_GET_SIZE(ob))};
+        }
+    };
+}
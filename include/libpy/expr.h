@@ -0,0 +1,460 @@
+#pragma once
+
+#include <type_traits>
+
+#include "libpy/long.h"
+#include "libpy/object.h"
+
+namespace py {
+    /**
+       Lazy arithmetic on `py::object`s.
+
+       Wrapping an operand in `lazy` makes the arithmetic operators build an
+       expression tree instead of calling `PyNumber_*` for each operator:
+
+       @code
+       using py::expr::lazy;
+       py::tmpref<py::object> r = lazy(a) + lazy(b) * 2 - d;
+       @endcode
+
+       The tree is evaluated once, when it is converted to a
+       `tmpref<py::object>` or when `eval` is called. If every leaf is an
+       exact `int` that fits in a machine word or an exact `float`, the whole
+       tree is computed on native values and only the result is boxed.
+       Otherwise, including when an intermediate `int` would overflow, the
+       tree is evaluated left to right with the number protocol exactly like
+       the eager operators, so subclasses and `NotImplemented` behave the
+       same.
+
+       Leaves hold borrowed references. An expression must be evaluated
+       before the objects it refers to are released, which in practice means
+       within the full expression that builds it, so do not store one in an
+       `auto` variable that outlives a temporary operand.
+
+       Note that C++ precedence still applies: in `lazy(a) + b * c` the
+       product `b * c` is computed eagerly; write `lazy(a) + lazy(b) * c` to
+       fuse it as well.
+    */
+    namespace expr {
+        /**
+           The operators which can be fused.
+        */
+        enum class op {
+            add,
+            sub,
+            mul,
+            div,
+        };
+
+        /**
+           The value of a subexpression during native evaluation.
+        */
+        struct _value {
+            bool is_float;
+            long long i;
+            double d;
+
+            double as_double() const {
+                return is_float ? d : static_cast<double>(i);
+            }
+        };
+
+        /**
+           Check if an `int` converts to a double without rounding, which is
+           when `int / int` is a single correctly rounded division.
+        */
+        inline bool _exact_double(long long i) {
+            const long long limit = 1LL << 53;
+            return i >= -limit && i <= limit;
+        }
+
+        /**
+           Compute `a op b` with Python's semantics.
+
+           @return true if `out` was written, false if the result must be
+                   computed with the number protocol: the result overflows,
+                   it would raise, or it is not exactly representable.
+        */
+        template<op o>
+        inline bool _apply(const _value &a, const _value &b, _value &out) {
+            if (!a.is_float && !b.is_float) {
+                out.is_float = false;
+                switch (o) {
+                case op::add:
+                    return long_::_apply<long_::_op::add>(a.i, b.i, out.i);
+                case op::sub:
+                    return long_::_apply<long_::_op::sub>(a.i, b.i, out.i);
+                case op::mul:
+                    return long_::_apply<long_::_op::mul>(a.i, b.i, out.i);
+                case op::div:
+                    if (!b.i || !_exact_double(a.i) || !_exact_double(b.i)) {
+                        return false;
+                    }
+                    out.is_float = true;
+                    out.d = static_cast<double>(a.i) /
+                        static_cast<double>(b.i);
+                    return true;
+                }
+                return false;
+            }
+
+            // `float` coerces the other operand to a double, which rounds
+            // the same way as the C++ conversion
+            double x = a.as_double();
+            double y = b.as_double();
+            out.is_float = true;
+            switch (o) {
+            case op::add:
+                out.d = x + y;
+                return true;
+            case op::sub:
+                out.d = x - y;
+                return true;
+            case op::mul:
+                out.d = x * y;
+                return true;
+            case op::div:
+                if (y == 0.0) {
+                    // let Python raise the `ZeroDivisionError`
+                    return false;
+                }
+                out.d = x / y;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+           Box the result of native evaluation.
+        */
+        inline PyObject *_box(const _value &value) {
+            return value.is_float ?
+                PyFloat_FromDouble(value.d) :
+                long_::_box(value.i);
+        }
+
+        /**
+           Base class of all expression nodes.
+
+           `E` must provide:
+
+           - `bool native(_value &out) const`, which computes the node on
+             native values without touching the interpreter state.
+           - `PyObject *generic() const`, which computes the node with the
+             number protocol and returns a new reference or nullptr with a
+             Python exception set.
+        */
+        template<typename E>
+        class node {
+        public:
+            const E &self() const {
+                return static_cast<const E&>(*this);
+            }
+
+            /**
+               Evaluate the expression.
+
+               @return The result or nullptr with a Python exception set.
+            */
+            tmpref<py::object> eval() const {
+                _value value = {false, 0, 0.0};
+                if (self().native(value)) {
+                    return _box(value);
+                }
+                return self().generic();
+            }
+
+            operator tmpref<py::object>() const {
+                return eval();
+            }
+        };
+
+        /**
+           A `py::object` operand.
+        */
+        class leaf : public node<leaf> {
+        private:
+            PyObject *ob;
+
+        public:
+            explicit leaf(const py::object &ob) : ob((PyObject*) ob) {}
+
+            bool native(_value &out) const {
+                if (!ob) {
+                    return false;
+                }
+                if (PyLong_CheckExact(ob)) {
+                    out.is_float = false;
+                    return long_::_as_word(ob, out.i);
+                }
+                if (PyFloat_CheckExact(ob)) {
+                    out.is_float = true;
+                    out.d = PyFloat_AS_DOUBLE(ob);
+                    return true;
+                }
+                return false;
+            }
+
+            PyObject *generic() const {
+                if (!ob) {
+                    pyutils::failed_null_check();
+                    return nullptr;
+                }
+                Py_INCREF(ob);
+                return ob;
+            }
+        };
+
+        /**
+           A C++ arithmetic operand. It is only boxed if the expression falls
+           back to the number protocol.
+        */
+        template<typename T>
+        class scalar : public node<scalar<T>> {
+        private:
+            T value;
+
+        public:
+            explicit scalar(T value) : value(value) {}
+
+            bool native(_value &out) const {
+                if (std::is_floating_point<T>::value) {
+                    out.is_float = true;
+                    out.d = static_cast<double>(value);
+                    return true;
+                }
+                out.is_float = false;
+                out.i = static_cast<long long>(value);
+                return long_::_fits_word(value);
+            }
+
+            PyObject *generic() const {
+                if (std::is_floating_point<T>::value) {
+                    return PyFloat_FromDouble(static_cast<double>(value));
+                }
+                return long_::_box_integer(value);
+            }
+        };
+
+        /**
+           The number protocol function for each operator.
+        */
+        template<op o>
+        struct _generic;
+
+        template<>
+        struct _generic<op::add> {
+            static PyObject *f(PyObject *a, PyObject *b) {
+                return PyNumber_Add(a, b);
+            }
+        };
+
+        template<>
+        struct _generic<op::sub> {
+            static PyObject *f(PyObject *a, PyObject *b) {
+                return PyNumber_Subtract(a, b);
+            }
+        };
+
+        template<>
+        struct _generic<op::mul> {
+            static PyObject *f(PyObject *a, PyObject *b) {
+                return PyNumber_Multiply(a, b);
+            }
+        };
+
+        template<>
+        struct _generic<op::div> {
+            static PyObject *f(PyObject *a, PyObject *b) {
+                return PyNumber_TrueDivide(a, b);
+            }
+        };
+
+        /**
+           A binary operator applied to two subexpressions.
+        */
+        template<op o, typename L, typename R>
+        class binary : public node<binary<o, L, R>> {
+        private:
+            L lhs;
+            R rhs;
+
+        public:
+            binary(const L &lhs, const R &rhs) : lhs(lhs), rhs(rhs) {}
+
+            bool native(_value &out) const {
+                _value a = {false, 0, 0.0};
+                _value b = {false, 0, 0.0};
+                return lhs.native(a) && rhs.native(b) && _apply<o>(a, b, out);
+            }
+
+            PyObject *generic() const {
+                PyObject *a = lhs.generic();
+                if (!a) {
+                    return nullptr;
+                }
+                PyObject *b = rhs.generic();
+                if (!b) {
+                    Py_DECREF(a);
+                    return nullptr;
+                }
+                PyObject *out = _generic<o>::f(a, b);
+                Py_DECREF(a);
+                Py_DECREF(b);
+                return out;
+            }
+        };
+
+        /**
+           Start a lazy expression.
+
+           @param ob The first operand.
+           @return   A leaf which builds an expression tree when combined with
+                     the arithmetic operators.
+        */
+        inline leaf lazy(const py::object &ob) {
+            return leaf(ob);
+        }
+
+        template<typename T>
+        using _enable_if_object_t =
+            std::enable_if_t<std::is_base_of<py::object, T>::value, int>;
+
+        template<typename T>
+        using _enable_if_scalar_t =
+            std::enable_if_t<std::is_arithmetic<T>::value &&
+                             !std::is_same<T, bool>::value,
+                             int>;
+
+#define LIBPY_EXPR_OPERATOR(sym, o)                                     \
+        template<typename L, typename R>                                \
+        binary<o, L, R> operator sym(const node<L> &lhs,                \
+                                     const node<R> &rhs) {              \
+            return {lhs.self(), rhs.self()};                            \
+        }                                                               \
+                                                                        \
+        template<typename L, typename R, _enable_if_object_t<R> = 0>    \
+        binary<o, L, leaf> operator sym(const node<L> &lhs,             \
+                                        const R &rhs) {                 \
+            return {lhs.self(), leaf(rhs)};                             \
+        }                                                               \
+                                                                        \
+        template<typename L, typename R, _enable_if_object_t<L> = 0>    \
+        binary<o, leaf, R> operator sym(const L &lhs,                   \
+                                        const node<R> &rhs) {           \
+            return {leaf(lhs), rhs.self()};                             \
+        }                                                               \
+                                                                        \
+        template<typename L, typename R, _enable_if_scalar_t<R> = 0>    \
+        binary<o, L, scalar<R>> operator sym(const node<L> &lhs,        \
+                                             R rhs) {                   \
+            return {lhs.self(), scalar<R>(rhs)};                        \
+        }                                                               \
+                                                                        \
+        template<typename L, typename R, _enable_if_scalar_t<L> = 0>    \
+        binary<o, scalar<L>, R> operator sym(L lhs,                     \
+                                             const node<R> &rhs) {      \
+            return {scalar<L>(lhs), rhs.self()};                        \
+        }
+
+        LIBPY_EXPR_OPERATOR(+, op::add)
+        LIBPY_EXPR_OPERATOR(-, op::sub)
+        LIBPY_EXPR_OPERATOR(*, op::mul)
+        LIBPY_EXPR_OPERATOR(/, op::div)
+
+#undef LIBPY_EXPR_OPERATOR
+
+        /**
+           Overwrite a uniquely referenced exact `int` or `float` with the
+           result of native evaluation.
+
+           @return true if `ob` now holds `value`, false if a new object must
+                   be allocated: the types differ or the `int` needs more
+                   storage than `ob` has.
+        */
+        inline bool _store(PyObject *ob, const _value &value) {
+            if (value.is_float) {
+                if (!PyFloat_CheckExact(ob)) {
+                    return false;
+                }
+                ((PyFloatObject*) ob)->ob_fval = value.d;
+                return true;
+            }
+            return PyLong_CheckExact(ob) && long_::_store_word(ob, value.i);
+        }
+
+        /**
+           Compute `lhs op rhs` into `lhs` if nothing else can observe it.
+
+           @return true if `lhs` now holds the result.
+        */
+        template<op o, typename R>
+        inline bool _reuse(PyObject *lhs, const R &rhs) {
+            if (!lhs || Py_REFCNT(lhs) != 1) {
+                return false;
+            }
+            _value a = {false, 0, 0.0};
+            _value b = {false, 0, 0.0};
+            _value out = {false, 0, 0.0};
+            return leaf(py::object(lhs)).native(a) &&
+                rhs.native(b) &&
+                _apply<o>(a, b, out) &&
+                _store(lhs, out);
+        }
+
+        template<typename T>
+        using _enable_if_operand_t =
+            std::enable_if_t<std::is_base_of<py::object, T>::value ||
+                             (std::is_arithmetic<T>::value &&
+                              !std::is_same<T, bool>::value),
+                             int>;
+
+        template<typename T, bool = std::is_arithmetic<T>::value>
+        struct _operand {
+            using type = leaf;
+        };
+
+        template<typename T>
+        struct _operand<T, true> {
+            using type = scalar<T>;
+        };
+    }
+
+    /**
+       Arithmetic on a temporary left hand side.
+
+       A `tmpref` rvalue whose object has a refcount of 1 is the only
+       reference to that object, like the intermediate results of
+       `a + 1_p + 2.5_p`. When it is an exact `int` or `float` and the result
+       has the same type and fits in its storage, the result is written into
+       it and the reference is moved into the return value instead of
+       allocating a new object. In every other case this is the same as the
+       operator on `T`.
+
+       `PyNumber_InPlace*` is deliberately not used for other types: `x += y`
+       may differ from `x + y`, for example `list += tuple` succeeds where
+       `list + tuple` raises.
+    */
+#define LIBPY_INPLACE_OPERATOR(sym, o)                                  \
+    template<typename T,                                                \
+             typename U,                                                \
+             expr::_enable_if_operand_t<U> = 0,                         \
+             typename R = decltype(std::declval<const T&>() sym         \
+                                   std::declval<const U&>())>           \
+    R operator sym(tmpref<T> &&lhs, const U &rhs) {                     \
+        using operand = typename expr::_operand<U>::type;               \
+        PyObject *ob = (PyObject*) lhs;                                 \
+        if (expr::_reuse<o>(ob, operand(rhs))) {                        \
+            std::move(lhs).invalidate();                                \
+            return R(ob);                                               \
+        }                                                               \
+        return static_cast<const T&>(lhs) sym rhs;                      \
+    }
+
+    LIBPY_INPLACE_OPERATOR(+, expr::op::add)
+    LIBPY_INPLACE_OPERATOR(-, expr::op::sub)
+    LIBPY_INPLACE_OPERATOR(*, expr::op::mul)
+    LIBPY_INPLACE_OPERATOR(/, expr::op::div)
+
+#undef LIBPY_INPLACE_OPERATOR
+}
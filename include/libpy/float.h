@@ -0,0 +1,385 @@
+#pragma once
+
+#include <type_traits>
+
+#include "libpy/object.h"
+#include "libpy/type.h"
+
+namespace py {
+    namespace float_ {
+        class object;
+
+        /**
+           Template that selects float_::object if O is float_::object else
+           return py::object.
+
+           Subclasses like nonnull or tmpref also select float_::object so
+           that the result is never wrapped in a second tmpref.
+        */
+        template<typename O>
+        using maybe_float_t = typename std::conditional<
+            std::is_base_of<object, O>::value,
+            object,
+            py::object>::type;
+
+        /**
+           The arithmetic operations which are computed on native doubles.
+        */
+        enum class _op {
+            add,
+            sub,
+            mul,
+            div,
+        };
+
+        /**
+           Compute `a op b` and box the result.
+
+           @return A new `float` or nullptr with a Python exception set.
+        */
+        template<_op op>
+        inline PyObject *_apply(double a, double b) {
+            switch (op) {
+            case _op::add:
+                return PyFloat_FromDouble(a + b);
+            case _op::sub:
+                return PyFloat_FromDouble(a - b);
+            case _op::mul:
+                return PyFloat_FromDouble(a * b);
+            case _op::div:
+                if (b == 0.0) {
+                    PyErr_SetString(PyExc_ZeroDivisionError,
+                                    "float division by zero");
+                    return nullptr;
+                }
+                return PyFloat_FromDouble(a / b);
+            }
+            return nullptr;
+        }
+
+        /**
+           Read an operand as a native double if doing so gives the same
+           result as Python's number protocol: exact `float` objects and
+           exact `int` objects which convert to a double.
+
+           @param ob  The operand.
+           @param out The value of `ob`.
+           @return    1 if `out` was written, 0 if `ob` must use the generic
+                      path, -1 if an exception occured.
+        */
+        inline int _as_native(PyObject *ob, double &out) {
+            if (PyFloat_CheckExact(ob)) {
+                out = PyFloat_AS_DOUBLE(ob);
+                return 1;
+            }
+            if (PyLong_CheckExact(ob)) {
+                // `float.__add__` raises the same `OverflowError` for ints
+                // which do not fit in a double
+                out = PyLong_AsDouble(ob);
+                return (out == -1.0 && PyErr_Occurred()) ? -1 : 1;
+            }
+            return 0;
+        }
+
+        /**
+           Apply `op` to two objects, at least one of which is a `float`,
+           without dispatching through the number protocol when both are
+           exact builtin numbers.
+        */
+        template<_op op, PyObject *generic(PyObject*, PyObject*)>
+        inline PyObject *_binary(PyObject *a, PyObject *b) {
+            double lhs;
+            double rhs;
+            int lhs_native = _as_native(a, lhs);
+            if (lhs_native < 0) {
+                return nullptr;
+            }
+            int rhs_native = lhs_native ? _as_native(b, rhs) : 0;
+            if (rhs_native < 0) {
+                return nullptr;
+            }
+            if (lhs_native && rhs_native) {
+                return _apply<op>(lhs, rhs);
+            }
+            return generic(a, b);
+        }
+
+        /**
+           Apply `op` to an object and a C++ double without boxing the double
+           when the object is an exact builtin number.
+        */
+        template<_op op, PyObject *generic(PyObject*, PyObject*)>
+        inline PyObject *_binary(PyObject *a, double b, bool reflected) {
+            double native;
+            int is_native = _as_native(a, native);
+            if (is_native < 0) {
+                return nullptr;
+            }
+            if (is_native) {
+                return reflected ? _apply<op>(b, native) : _apply<op>(native, b);
+            }
+
+            // subclasses and other numbers see a real `float`
+            PyObject *boxed = PyFloat_FromDouble(b);
+            if (!boxed) {
+                return nullptr;
+            }
+            PyObject *out = reflected ? generic(boxed, a) : generic(a, boxed);
+            Py_DECREF(boxed);
+            return out;
+        }
+
+        /**
+           A subclass of `py::object` for optional `float` objects.
+
+           The `+`, `-`, `*`, and `/` operators compute directly on the
+           stored doubles when both operands are exact `float` or `int`
+           objects, or when one side is a C++ double, and only allocate the
+           result. Everything else goes through the number protocol.
+        */
+        class object : public py::object {
+        private:
+            /**
+               Function called to verify that `ob` is a float and
+               correctly raise a python exception otherwise.
+            */
+            void float_check();
+
+            template<_op op,
+                     PyObject *generic(PyObject*, PyObject*),
+                     typename T>
+            inline PyObject *float_binary_func(const T &other) const {
+                if (!pyutils::all_nonnull(*this, other)) {
+                    pyutils::failed_null_check();
+                    return nullptr;
+                }
+                return _binary<op, generic>(ob, (PyObject*) other);
+            }
+
+            template<_op op, PyObject *generic(PyObject*, PyObject*)>
+            inline PyObject *double_binary_func(double other) const {
+                if (!is_nonnull()) {
+                    pyutils::failed_null_check();
+                    return nullptr;
+                }
+                return _binary<op, generic>(ob, other, false);
+            }
+
+        public:
+            friend tmpref<object>;
+
+            /**
+               Default constructor. This will set `ob` to nullptr.
+            */
+            object();
+
+            /**
+               Constructor from a C++ double.
+
+               This constructor is explicit because the user must manually
+               decref the object. If an expression was implicitly upcast to
+               float_::object there could be a leak.
+
+               @param d The value of the new `float`.
+            */
+            explicit object(double d);
+
+            /**
+               Constructor from `PyObject*`. If `pob` is not a `float` then
+               `ob` will be set to `nullptr`.
+            */
+            object(PyObject *pob);
+
+            /**
+               Constructor from `py::object`. If `pob` is not a `float` then
+               `ob` will be set to `nullptr`.
+            */
+            object(const py::object &pob);
+
+            object(const object &cpfrom);
+            object(object &&mvfrom) noexcept;
+
+            using py::object::operator=;
+
+            /**
+               Get the value of the object.
+
+               @return The value or -1.0 if an exception occured.
+            */
+            double as_double() const;
+
+            nonnull<object> as_nonnull() const;
+            tmpref<object> as_tmpref() &&;
+
+            template<typename T,
+                     typename = std::enable_if_t<
+                         std::is_base_of<py::object, T>::value>>
+            tmpref<maybe_float_t<T>> operator+(const T &other) const {
+                return float_binary_func<_op::add, PyNumber_Add>(other);
+            }
+
+            tmpref<object> operator+(double other) const {
+                return double_binary_func<_op::add, PyNumber_Add>(other);
+            }
+
+            template<typename T,
+                     typename = std::enable_if_t<
+                         std::is_base_of<py::object, T>::value>>
+            tmpref<maybe_float_t<T>> operator-(const T &other) const {
+                return float_binary_func<_op::sub, PyNumber_Subtract>(other);
+            }
+
+            tmpref<object> operator-(double other) const {
+                return double_binary_func<_op::sub, PyNumber_Subtract>(other);
+            }
+
+            template<typename T,
+                     typename = std::enable_if_t<
+                         std::is_base_of<py::object, T>::value>>
+            tmpref<maybe_float_t<T>> operator*(const T &other) const {
+                return float_binary_func<_op::mul, PyNumber_Multiply>(other);
+            }
+
+            tmpref<object> operator*(double other) const {
+                return double_binary_func<_op::mul, PyNumber_Multiply>(other);
+            }
+
+            template<typename T,
+                     typename = std::enable_if_t<
+                         std::is_base_of<py::object, T>::value>>
+            tmpref<maybe_float_t<T>> operator/(const T &other) const {
+                return float_binary_func<_op::div,
+                                         PyNumber_TrueDivide>(other);
+            }
+
+            tmpref<object> operator/(double other) const {
+                return double_binary_func<_op::div,
+                                          PyNumber_TrueDivide>(other);
+            }
+
+            tmpref<object> operator-() const;
+            tmpref<object> operator+() const;
+            tmpref<object> abs() const;
+        };
+
+        /**
+           Reflected operators for a C++ double on the left hand side.
+        */
+        inline tmpref<object> operator+(double a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::add, PyNumber_Add>((PyObject*) b, a, true);
+        }
+
+        inline tmpref<object> operator-(double a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::sub, PyNumber_Subtract>((PyObject*) b,
+                                                        a,
+                                                        true);
+        }
+
+        inline tmpref<object> operator*(double a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::mul, PyNumber_Multiply>((PyObject*) b,
+                                                        a,
+                                                        true);
+        }
+
+        inline tmpref<object> operator/(double a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::div, PyNumber_TrueDivide>((PyObject*) b,
+                                                          a,
+                                                          true);
+        }
+
+        /**
+           The type of Python `float` objects.
+
+           This is equivalent to: `float`.
+        */
+        extern const type::object<float_::object> type;
+
+        /**
+           Check if an object is an instance of `float`.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `float`, 0 if `ob` is not an
+                    instance of `float`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int check(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyFloat_Check((PyObject*) t);
+        }
+
+        inline int check(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Check if an object is an instance of `float` but not a subclass.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `float`, 0 if `ob` is not an
+                    instance of `float`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int checkexact(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyFloat_CheckExact((PyObject*) t);
+        }
+
+        inline int checkexact(const nonnull<object>&) {
+            return 1;
+        }
+    }
+
+    template<char... cs>
+    struct _numeric_literal<true, cs...> {
+        using type = float_::object;
+
+        static PyObject *make() {
+            char data[] = {cs..., '\0'};
+            char *out = data;
+
+            // drop the digit separators
+            for (char c : data) {
+                if (c != '\'') {
+                    *out++ = c;
+                }
+            }
+
+            // `strtod` reads the decimal point from `LC_NUMERIC`, which an
+            // embedding application may have changed, so parse the same way
+            // Python does
+            if (data[0] == '0' && (data[1] == 'x' || data[1] == 'X')) {
+                return PyObject_CallMethod((PyObject*) &PyFloat_Type,
+                                           "fromhex",
+                                           "s",
+                                           data);
+            }
+            double value = PyOS_string_to_double(data, nullptr, nullptr);
+            if (value == -1.0 && PyErr_Occurred()) {
+                return nullptr;
+            }
+            return PyFloat_FromDouble(value);
+        }
+    };
+}
@@ -5,4 +5,10 @@
 #include "libpy/type.h"
 #include "libpy/list.h"
 #include "libpy/long.h"
+#include "libpy/float.h"
+#include "libpy/expr.h"
+#include "libpy/unicode.h"
+#include "libpy/bytes.h"
+#include "libpy/bytearray.h"
+#include "libpy/span.h"
 #include "libpy/utils.h"
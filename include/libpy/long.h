@@ -1,19 +1,34 @@
 #pragma once
 
+#include <climits>
+#include <cstddef>
+#include <limits>
 #include <type_traits>
+#include <vector>
 
+#include <libpy/list.h>
 #include <libpy/object.h>
+#include <libpy/span.h>
+#include <libpy/tuple.h>
+
+#if PY_VERSION_HEX < 0x030B0000
+// `PyLongObject`'s digits are only exposed through `Python.h` from 3.11
+#include <longintrepr.h>
+#endif
+
+#define HAVE_COMPACT_LONG (PY_VERSION_HEX >= 0x030C0000)
+
+#ifdef __SIZEOF_INT128__
+#define HAVE_INT128 1
+#else
+#define HAVE_INT128 0
+#endif
 
 namespace py {
     namespace long_ {
         class object;
     }
 
-    /**
-       Operator overload for long objects.
-    */
-    const long_::object &operator""_p(unsigned long long l);
-
     namespace long_ {
 
         class object;
@@ -23,15 +38,378 @@ namespace py {
                Template that selects long_::object if O is long_::object else
                return py::object.
 
-               This will work for subclasses like nonnull or tmpref.
+               Subclasses like nonnull or tmpref also select long_::object so
+               that the result is never wrapped in a second tmpref.
             */
             template<typename O>
             using maybe_long_t = typename std::conditional<
                 std::is_base_of<object, O>::value,
-                O,
+                object,
                 py::object>::type;
         }
 
+        /**
+           Read an exact `int` as a machine word without going through the
+           number protocol.
+
+           @param ob  An exact `int`.
+           @param out The value of `ob`.
+           @return    true if `ob` fits in a `long long`. When this is false
+                      `ob` is a bignum, `out` is unspecified, and no exception
+                      is set.
+        */
+        inline bool _as_word(PyObject *ob, long long &out) {
+#if HAVE_COMPACT_LONG
+            if (PyUnstable_Long_IsCompact((PyLongObject*) ob)) {
+                out = PyUnstable_Long_CompactValue((PyLongObject*) ob);
+                return true;
+            }
+#else
+            // at most two digits always fit: they are 15 or 30 bits each
+            const digit *digits = ((PyLongObject*) ob)->ob_digit;
+            switch (Py_SIZE(ob)) {
+            case 0:
+                out = 0;
+                return true;
+            case 1:
+                out = digits[0];
+                return true;
+            case -1:
+                out = -static_cast<long long>(digits[0]);
+                return true;
+            case 2:
+                out = (static_cast<long long>(digits[1]) << PyLong_SHIFT) |
+                    digits[0];
+                return true;
+            case -2:
+                out = -((static_cast<long long>(digits[1]) << PyLong_SHIFT) |
+                        digits[0]);
+                return true;
+            }
+#endif
+            int overflow;
+            out = PyLong_AsLongLongAndOverflow(ob, &overflow);
+            return !overflow;
+        }
+
+        /**
+           The state of the box cache, see `enable_box_cache`.
+        */
+        struct _box_cache_state {
+            /**
+               The cached objects for `[low, low + size)`, or nullptr when
+               the cache is disabled.
+            */
+            PyObject **table;
+            /**
+               The interpreter which created the objects in `table`.
+            */
+            PyInterpreterState *owner;
+            long long low;
+            unsigned long long size;
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t bytes;
+        };
+
+        extern _box_cache_state _box_cache;
+
+        /**
+           Box a machine word. Values in `[-5, 256]` are the interpreter's
+           shared small int objects and do not allocate, and neither do
+           values in the box cache when it is enabled by the caller's
+           interpreter.
+
+           @return A new reference or nullptr with a Python exception set.
+        */
+        inline PyObject *_box(long long value) {
+            if (_box_cache.table &&
+                PyThreadState_Get()->interp == _box_cache.owner) {
+                // values below `low` wrap around to large offsets
+                unsigned long long offset =
+                    static_cast<unsigned long long>(value) -
+                    static_cast<unsigned long long>(_box_cache.low);
+                if (offset < _box_cache.size) {
+                    ++_box_cache.hits;
+                    PyObject *ob = _box_cache.table[offset];
+                    Py_INCREF(ob);
+                    return ob;
+                }
+                ++_box_cache.misses;
+            }
+            return PyLong_FromLongLong(value);
+        }
+
+        /**
+           Overwrite the value of an exact `int` which nothing else
+           references, reusing its allocation.
+
+           Only values that fit in the single digit the object already has
+           are stored. Values in the small int range are left to `_box` so
+           that they stay the interpreter's shared objects.
+
+           @param ob    An exact `int` with a refcount of 1.
+           @param value The new value.
+           @return      true if `ob` now holds `value`.
+        */
+        inline bool _store_word(PyObject *ob, long long value) {
+            if (value >= -5 && value <= 256) {
+                return false;
+            }
+            unsigned long long magnitude = value < 0 ?
+                -static_cast<unsigned long long>(value) :
+                static_cast<unsigned long long>(value);
+            if (magnitude >> PyLong_SHIFT) {
+                return false;
+            }
+
+#if HAVE_COMPACT_LONG
+            _PyLongValue &repr = ((PyLongObject*) ob)->long_value;
+            if ((repr.lv_tag >> _PyLong_NON_SIZE_BITS) != 1) {
+                return false;
+            }
+            // the sign bits are 0 for positive and 2 for negative
+            repr.lv_tag = (1 << _PyLong_NON_SIZE_BITS) | (value < 0 ? 2 : 0);
+            repr.ob_digit[0] = static_cast<digit>(magnitude);
+#else
+            PyVarObject *var = (PyVarObject*) ob;
+            if (var->ob_size != 1 && var->ob_size != -1) {
+                return false;
+            }
+            var->ob_size = value < 0 ? -1 : 1;
+            ((PyLongObject*) ob)->ob_digit[0] = static_cast<digit>(magnitude);
+#endif
+            return true;
+        }
+
+        /**
+           The operations which have a machine word fast path.
+        */
+        enum class _op {
+            add,
+            sub,
+            mul,
+            mod,
+            lshift,
+            rshift,
+            and_,
+            xor_,
+            or_,
+        };
+
+        /**
+           Compute `a op b` with Python's semantics.
+
+           @param out The result.
+           @return    true if `out` was written, false if the result does not
+                      fit in a machine word or the operation raises in Python.
+        */
+        template<_op op>
+        inline bool _apply(long long a, long long b, long long &out) {
+            switch (op) {
+            case _op::add:
+                return !__builtin_add_overflow(a, b, &out);
+            case _op::sub:
+                return !__builtin_sub_overflow(a, b, &out);
+            case _op::mul:
+                return !__builtin_mul_overflow(a, b, &out);
+            case _op::mod:
+                if (!b) {
+                    // Python raises the `ZeroDivisionError`
+                    return false;
+                }
+                if (b == -1) {
+                    // `LLONG_MIN % -1` is undefined in C++
+                    out = 0;
+                    return true;
+                }
+                out = a % b;
+                if (out && ((out < 0) != (b < 0))) {
+                    // Python's remainder takes the sign of the divisor
+                    out += b;
+                }
+                return true;
+            case _op::lshift:
+                if (b < 0 || b >= 64) {
+                    // negative shifts raise, and only 0 survives a large one
+                    out = 0;
+                    return b >= 0 && !a;
+                }
+                out = static_cast<long long>(
+                    static_cast<unsigned long long>(a) << b);
+                return (out >> b) == a;
+            case _op::rshift:
+                if (b < 0) {
+                    return false;
+                }
+                // `>>` on a signed value is arithmetic which floors like Python
+                out = a >> (b < 63 ? b : 63);
+                return true;
+            case _op::and_:
+                out = a & b;
+                return true;
+            case _op::xor_:
+                out = a ^ b;
+                return true;
+            case _op::or_:
+                out = a | b;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+           Apply `op` to two objects, computing on machine words when both
+           are exact `int` objects that fit in one. Bignums, subclasses,
+           overflowing results, and errors go through `generic`.
+        */
+        template<_op op, PyObject *generic(PyObject*, PyObject*)>
+        inline PyObject *_binary(PyObject *a, PyObject *b) {
+            long long lhs;
+            long long rhs;
+            long long out;
+            if (PyLong_CheckExact(a) && PyLong_CheckExact(b) &&
+                _as_word(a, lhs) && _as_word(b, rhs) &&
+                _apply<op>(lhs, rhs, out)) {
+                return _box(out);
+            }
+            return generic(a, b);
+        }
+
+        /**
+           The order of the bytes in the byte array representation of an
+           `int`.
+        */
+        enum class byteorder {
+            little,
+            big,
+            native = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? little : big,
+        };
+
+        /**
+           Create an `int` from `n` bytes.
+
+           @return A new reference or nullptr with a Python exception set.
+        */
+        inline PyObject *_from_byte_array(const void *data,
+                                          std::size_t n,
+                                          byteorder order,
+                                          bool is_signed) {
+            return _PyLong_FromByteArray(
+                static_cast<const unsigned char*>(data),
+                n,
+                order == byteorder::little,
+                is_signed);
+        }
+
+        /**
+           Write the low `n` bytes of an `int`.
+
+           @return 0 on success, -1 with an `OverflowError` set if the value
+                   does not fit.
+        */
+        inline int _as_byte_array(PyObject *ob,
+                                  void *out,
+                                  std::size_t n,
+                                  byteorder order,
+                                  bool is_signed) {
+            return _PyLong_AsByteArray((PyLongObject*) ob,
+                                       static_cast<unsigned char*>(out),
+                                       n,
+                                       order == byteorder::little,
+                                       is_signed
+#if PY_VERSION_HEX >= 0x030D0000
+                                       , 1
+#endif
+                                       );
+        }
+
+        /**
+           Check if a C++ integer can be used as a machine word operand.
+        */
+        template<typename I>
+        inline bool _fits_word(I value) {
+            if (std::is_signed<I>::value) {
+                return sizeof(I) <= sizeof(long long) ||
+                    (value >= static_cast<I>(LLONG_MIN) &&
+                     value <= static_cast<I>(LLONG_MAX));
+            }
+            return sizeof(I) < sizeof(long long) ||
+                value <= static_cast<I>(LLONG_MAX);
+        }
+
+        /**
+           Box a C++ integer of any width and signedness, including
+           `__int128`.
+        */
+        template<typename I>
+        inline PyObject *_box_integer(I value) {
+            if (_fits_word(value)) {
+                return _box(static_cast<long long>(value));
+            }
+            if (sizeof(I) <= sizeof(unsigned long long)) {
+                return PyLong_FromUnsignedLongLong(
+                    static_cast<unsigned long long>(value));
+            }
+            return _from_byte_array(&value,
+                                    sizeof(I),
+                                    byteorder::native,
+                                    std::is_signed<I>::value);
+        }
+
+        /**
+           Box any C++ arithmetic value, truncating floating point values
+           like `int(value)`.
+        */
+        template<typename L>
+        inline std::enable_if_t<std::is_integral<L>::value, PyObject*>
+        _box_number(L value) {
+            return _box_integer(value);
+        }
+
+        template<typename L>
+        inline std::enable_if_t<!std::is_integral<L>::value, PyObject*>
+        _box_number(L value) {
+            return PyLong_FromDouble(value);
+        }
+
+        /**
+           Apply `op` to an object and a C++ integer without boxing the
+           integer when the object is an exact `int` that fits in a machine
+           word and the result does too.
+
+           @param reflected Compute `b op a` instead of `a op b`.
+        */
+        template<_op op, PyObject *generic(PyObject*, PyObject*), typename I>
+        inline PyObject *_binary(PyObject *a, I b, bool reflected) {
+            long long word;
+            long long out;
+            if (_fits_word(b) && PyLong_CheckExact(a) && _as_word(a, word)) {
+                long long other = static_cast<long long>(b);
+                if (reflected ?
+                    _apply<op>(other, word, out) :
+                    _apply<op>(word, other, out)) {
+                    return _box(out);
+                }
+            }
+
+            PyObject *boxed = _box_integer(b);
+            if (!boxed) {
+                return nullptr;
+            }
+            PyObject *res = reflected ? generic(boxed, a) : generic(a, boxed);
+            Py_DECREF(boxed);
+            return res;
+        }
+
+        template<typename T>
+        using _enable_if_object_t =
+            std::enable_if_t<std::is_base_of<py::object, T>::value, int>;
+
+        template<typename I>
+        using _enable_if_integral_t =
+            std::enable_if_t<std::is_integral<I>::value, int>;
+
         class object : public py::object {
         private:
             /**
@@ -57,9 +435,30 @@ namespace py {
                 }
                 return func(ob, &overflow);
             }
+
+            template<_op op,
+                     PyObject *generic(PyObject*, PyObject*),
+                     typename T>
+            inline PyObject *long_binary_func(const T &other) const {
+                if (!pyutils::all_nonnull(*this, other)) {
+                    pyutils::failed_null_check();
+                    return nullptr;
+                }
+                return _binary<op, generic>(ob, (PyObject*) other);
+            }
+
+            template<_op op,
+                     PyObject *generic(PyObject*, PyObject*),
+                     typename I>
+            inline PyObject *integer_binary_func(I other) const {
+                if (!is_nonnull()) {
+                    pyutils::failed_null_check();
+                    return nullptr;
+                }
+                return _binary<op, generic>(ob, other, false);
+            }
         public:
             friend tmpref<object>;
-            friend const object &py::operator""_p(unsigned long long l);
 
             /**
                Default constructor. This will set `ob` to nullptr.
@@ -77,12 +476,7 @@ namespace py {
             */
             template<typename L,
                      typename = std::enable_if_t<std::is_arithmetic<L>::value>>
-            explicit object(L l) :
-                py::object(!std::is_integral<L>::value ?
-                           PyLong_FromDouble(l) :
-                           std::is_unsigned<L>::value ?
-                           PyLong_FromUnsignedLongLong(l) :
-                           PyLong_FromLongLong(l)) {}
+            explicit object(L l) : py::object(_box_number(l)) {}
 
             /**
                Constructor from `PyObject*`. If `pob` is not a `tuple` then
@@ -96,6 +490,15 @@ namespace py {
             */
             object(const py::object &pob);
 
+#if HAVE_INT128
+            /**
+               Constructors from 128 bit integers. These are explicit for the
+               same reason as the numeric constructor above.
+            */
+            explicit object(__int128 l);
+            explicit object(unsigned __int128 l);
+#endif
+
             object(const object &cpfrom);
             object(object &&mvfrom) noexcept;
 
@@ -112,22 +515,64 @@ namespace py {
             unsigned long long as_unsigned_long_long() const;
             double as_double() const;
 
+#if HAVE_INT128
+            /**
+               Get the value as a 128 bit integer.
+
+               @return The value or -1 if an exception occured.
+            */
+            __int128 as_int128() const;
+            unsigned __int128 as_uint128() const;
+#endif
+
+            /**
+               Write the value into `out.size()` bytes.
+
+               This is equivalent to:
+               `this.to_bytes(len(out), order, signed=is_signed)`.
+
+               @param out       The bytes to fill.
+               @param order     The order of the bytes.
+               @param is_signed Write a two's complement representation.
+               @return          0 on success, -1 if an exception occured. If
+                                the value does not fit an `OverflowError` is
+                                raised.
+            */
+            int as_bytes(span<char> out,
+                         byteorder order = byteorder::native,
+                         bool is_signed = true) const;
+
             nonnull<object> as_nonnull() const;
             tmpref<object> as_tmpref() &&;
 
-            template<typename T>
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator+(const T &other) const {
-                return ob_binary_func<PyNumber_Add>(other);
+                return long_binary_func<_op::add, PyNumber_Add>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator+(I other) const {
+                return integer_binary_func<_op::add, PyNumber_Add>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator-(const T &other) const {
-                return ob_binary_func<PyNumber_Subtract>(other);
+                return long_binary_func<_op::sub, PyNumber_Subtract>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator-(I other) const {
+                return integer_binary_func<_op::sub, PyNumber_Subtract>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator*(const T &other) const {
-                return ob_binary_func<PyNumber_Multiply>(other);
+                return long_binary_func<_op::mul, PyNumber_Multiply>(other);
+            }
+
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator*(I other) const {
+                return integer_binary_func<_op::mul, PyNumber_Multiply>(other);
             }
 
 #if CPP_HAVE_MATMUL
@@ -139,9 +584,15 @@ namespace py {
 
             // not overriding operator/ because long / long returns a float.
 
-            template<typename T>
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator%(const T &other) const {
-                return ob_binary_func<PyNumber_Remainder>(other);
+                return long_binary_func<_op::mod,
+                                        PyNumber_Remainder>(other);
+            }
+
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator%(I other) const {
+                return integer_binary_func<_op::mod, PyNumber_Remainder>(other);
             }
 
             template<typename T>
@@ -163,32 +614,150 @@ namespace py {
             tmpref<object> abs() const;
             tmpref<object> invert() const;
 
-            template<typename T>
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator<<(const T &other) const {
-                return ob_binary_func<PyNumber_Lshift>(other);
+                return long_binary_func<_op::lshift,
+                                        PyNumber_Lshift>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator<<(I other) const {
+                return integer_binary_func<_op::lshift, PyNumber_Lshift>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator>>(const T &other) const {
-                return ob_binary_func<PyNumber_Rshift>(other);
+                return long_binary_func<_op::rshift,
+                                        PyNumber_Rshift>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator>>(I other) const {
+                return integer_binary_func<_op::rshift, PyNumber_Rshift>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator&(const T &other) const {
-                return ob_binary_func<PyNumber_And>(other);
+                return long_binary_func<_op::and_, PyNumber_And>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator&(I other) const {
+                return integer_binary_func<_op::and_, PyNumber_And>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator^(const T &other) const {
-                return ob_binary_func<PyNumber_Xor>(other);
+                return long_binary_func<_op::xor_, PyNumber_Xor>(other);
             }
 
-            template<typename T>
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator^(I other) const {
+                return integer_binary_func<_op::xor_, PyNumber_Xor>(other);
+            }
+
+            template<typename T, _enable_if_object_t<T> = 0>
             tmpref<maybe_long_t<T>> operator|(const T &other) const {
-                return ob_binary_func<PyNumber_Or>(other);
+                return long_binary_func<_op::or_, PyNumber_Or>(other);
+            }
+
+            template<typename I, _enable_if_integral_t<I> = 0>
+            tmpref<object> operator|(I other) const {
+                return integer_binary_func<_op::or_, PyNumber_Or>(other);
             }
         };
 
+        /**
+           Reflected operators for a C++ integer on the left hand side, for
+           example `1 << n`.
+        */
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator+(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::add, PyNumber_Add>((PyObject*) b, a, true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator-(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::sub, PyNumber_Subtract>((PyObject*) b, a, true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator*(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::mul, PyNumber_Multiply>((PyObject*) b, a, true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator%(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::mod, PyNumber_Remainder>((PyObject*) b,
+                                                         a,
+                                                         true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator<<(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::lshift, PyNumber_Lshift>((PyObject*) b,
+                                                         a,
+                                                         true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator>>(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::rshift, PyNumber_Rshift>((PyObject*) b,
+                                                         a,
+                                                         true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator&(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::and_, PyNumber_And>((PyObject*) b, a, true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator^(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::xor_, PyNumber_Xor>((PyObject*) b, a, true);
+        }
+
+        template<typename I, _enable_if_integral_t<I> = 0>
+        inline tmpref<object> operator|(I a, const object &b) {
+            if (!b.is_nonnull()) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return _binary<_op::or_, PyNumber_Or>((PyObject*) b, a, true);
+        }
+
         /**
            Check if an object is an instance of `int`.
 
@@ -228,5 +797,368 @@ namespace py {
         inline int checkexact(const nonnull<object>&) {
             return 1;
         }
+
+        /**
+           Check if a machine word is representable as a `T`.
+        */
+        template<typename T>
+        inline bool _in_range(long long value) {
+            using limits = std::numeric_limits<T>;
+            if (std::is_unsigned<T>::value) {
+                return value >= 0 &&
+                    (sizeof(T) >= sizeof(long long) ||
+                     static_cast<unsigned long long>(value) <=
+                     static_cast<unsigned long long>(limits::max()));
+            }
+            return sizeof(T) >= sizeof(long long) ||
+                (value >= static_cast<long long>(limits::min()) &&
+                 value <= static_cast<long long>(limits::max()));
+        }
+
+        /**
+           Check that `S` is a sequence type whose items can be read and
+           written in place.
+        */
+        template<typename S>
+        using _is_fast_sequence = std::integral_constant<
+            bool,
+            std::is_base_of<list::object, S>::value ||
+            std::is_base_of<tuple::object, S>::value>;
+
+        /**
+           Convert a `list` or `tuple` of `int` objects into C++ integers.
+
+           The elements are read straight from the sequence's storage and
+           their digits are unpacked inline; the range check against `T` is
+           accumulated over the whole sequence and only inspected once at
+           the end.
+
+           @param seq The `list` or `tuple` to convert.
+           @return    The values of `seq`. If `seq` is null, an element is not
+                      an `int`, or an element does not fit in `T`, the result
+                      is empty and a Python exception is set.
+        */
+        template<typename T, typename S>
+        std::vector<T> to_vector(const S &seq) {
+            static_assert(std::is_integral<T>::value,
+                          "to_vector converts to integral types");
+            static_assert(_is_fast_sequence<S>::value,
+                          "to_vector reads a list::object or tuple::object");
+
+            if (!seq.is_nonnull()) {
+                pyutils::failed_null_check();
+                return {};
+            }
+
+            // `unsigned long long` and 128 bit integers reach past a machine
+            // word
+            constexpr bool wide = std::is_unsigned<T>::value ?
+                sizeof(T) >= sizeof(long long) :
+                sizeof(T) > sizeof(long long);
+            py::ssize_t size = PySequence_Fast_GET_SIZE((PyObject*) seq);
+            PyObject **items = PySequence_Fast_ITEMS((PyObject*) seq);
+            std::vector<T> out(size);
+            bool in_range = true;
+            for (py::ssize_t ix = 0; ix < size; ++ix) {
+                PyObject *item = items[ix];
+                long long word;
+
+                if (!PyLong_Check(item)) {
+                    PyErr_Format(PyExc_TypeError,
+                                 "expected int at index %zd, got %.200s",
+                                 ix,
+                                 Py_TYPE(item)->tp_name);
+                    return {};
+                }
+                if (!_as_word(item, word)) {
+                    if (wide) {
+                        if (_as_byte_array(item,
+                                           &out[ix],
+                                           sizeof(T),
+                                           byteorder::native,
+                                           std::is_signed<T>::value)) {
+                            return {};
+                        }
+                        continue;
+                    }
+                    word = -1;
+                    in_range = false;
+                }
+                out[ix] = static_cast<T>(word);
+                in_range &= _in_range<T>(word);
+            }
+
+            if (!in_range) {
+                for (py::ssize_t ix = 0; ix < size; ++ix) {
+                    long long word;
+                    bool fits = _as_word(items[ix], word) ?
+                        _in_range<T>(word) :
+                        wide;
+                    if (!fits) {
+                        PyErr_Format(PyExc_OverflowError,
+                                     "int at index %zd is out of range",
+                                     ix);
+                        break;
+                    }
+                }
+                return {};
+            }
+            return out;
+        }
+
+        /**
+           Convert C++ integers into a new `list`, or a `tuple` when `S` is
+           `tuple::object`.
+
+           The result is allocated once at its final size and each element
+           is boxed directly into its storage.
+
+           @param values The integers to convert.
+           @return       The new sequence or nullptr with a Python exception
+                         set.
+        */
+        template<typename S = list::object, typename T>
+        tmpref<S> from_span(span<const T> values) {
+            static_assert(std::is_integral<T>::value,
+                          "from_span converts from integral types");
+            static_assert(_is_fast_sequence<S>::value,
+                          "from_span builds a list::object or tuple::object");
+
+            S out(static_cast<py::ssize_t>(values.size()));
+            if (!out.is_nonnull()) {
+                return nullptr;
+            }
+
+            PyObject **items = PySequence_Fast_ITEMS((PyObject*) out);
+            for (std::size_t ix = 0; ix < values.size(); ++ix) {
+                PyObject *item = _box_integer(values[ix]);
+                if (!item) {
+                    // the unfilled slots are null which dealloc skips
+                    out.decref();
+                    return nullptr;
+                }
+                items[ix] = item;
+            }
+            return std::move(out).as_tmpref();
+        }
+
+        /**
+           Create an `int` from its byte array representation.
+
+           This is equivalent to:
+           `int.from_bytes(data, order, signed=is_signed)`.
+
+           @param data      The bytes to read.
+           @param order     The order of the bytes.
+           @param is_signed Read `data` as a two's complement representation.
+           @return          The new `int` or nullptr with a Python exception
+                            set.
+        */
+        tmpref<object> from_bytes(span<const char> data,
+                                  byteorder order = byteorder::native,
+                                  bool is_signed = true);
+
+        /**
+           Create a `list` of `int`s from fixed width byte array
+           representations packed end to end, for example a column of 128 bit
+           ids.
+
+           @param data      The bytes to read. The size must be a multiple of
+                            `width`.
+           @param width     The number of bytes in each integer.
+           @param order     The order of the bytes in each integer.
+           @param is_signed Read two's complement representations.
+           @return          The new list or nullptr with a Python exception
+                            set.
+        */
+        tmpref<list::object> from_bytes_array(span<const char> data,
+                                              std::size_t width,
+                                              byteorder order =
+                                                  byteorder::native,
+                                              bool is_signed = true);
+
+        int _as_bytes_array(PyObject *seq,
+                            span<char> out,
+                            std::size_t width,
+                            byteorder order,
+                            bool is_signed);
+
+        /**
+           Write the `int`s of a `list` or `tuple` as fixed width byte array
+           representations packed end to end.
+
+           @param seq       The `list` or `tuple` to write.
+           @param out       The bytes to fill. The size must be
+                            `len(seq) * width`.
+           @param width     The number of bytes in each integer.
+           @param order     The order of the bytes in each integer.
+           @param is_signed Write two's complement representations.
+           @return          0 on success, -1 if an exception occured.
+        */
+        template<typename S>
+        int as_bytes_array(const S &seq,
+                           span<char> out,
+                           std::size_t width,
+                           byteorder order = byteorder::native,
+                           bool is_signed = true) {
+            static_assert(_is_fast_sequence<S>::value,
+                          "as_bytes_array reads a list::object or "
+                          "tuple::object");
+            if (!seq.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return _as_bytes_array((PyObject*) seq,
+                                   out,
+                                   width,
+                                   order,
+                                   is_signed);
+        }
+
+        /**
+           Statistics about the box cache.
+        */
+        struct box_cache_info {
+            /**
+               The range of cached values, inclusive. `low > high` when the
+               cache is disabled.
+            */
+            long long low;
+            long long high;
+
+            /**
+               The number of machine words boxed since the cache was enabled
+               which were and were not in the cache.
+            */
+            std::size_t hits;
+            std::size_t misses;
+
+            /**
+               The memory held by the cache: the table and every object in
+               it other than the interpreter's shared small ints.
+            */
+            std::size_t bytes;
+
+            /**
+               The fraction of boxed machine words which were cached, or 0 if
+               nothing has been boxed.
+            */
+            double hit_rate() const {
+                std::size_t total = hits + misses;
+                return total ? static_cast<double>(hits) / total : 0.0;
+            }
+        };
+
+        /**
+           Preallocate the `int` objects for every value in `[low, high]` and
+           return them instead of allocating a new object whenever libpy
+           boxes a C++ integer in that range: the `long_::object`
+           constructors, the results of the arithmetic operators, and
+           `from_span`.
+
+           The cache is shared by the whole process and holds a reference to
+           each object so they live until `disable_box_cache` is called. It
+           is forgotten, without decrefing, when the interpreter is
+           finalized. Enabling it again replaces the previous range and
+           resets the statistics.
+
+           The cached objects are ordinary reference counted `int`s which
+           belong to the interpreter that enabled the cache. Other
+           interpreters, which may run under their own GIL, never use the
+           cache: they box a new object and do not count towards the
+           statistics. Enabling or disabling the cache from another
+           interpreter while it is enabled raises a `RuntimeError` or does
+           nothing, respectively.
+
+           This must be called with the GIL held.
+
+           @param low  The smallest cached value.
+           @param high The largest cached value.
+           @return     0 on success, -1 with a Python exception set on
+                       failure, in which case the cache is disabled unless
+                       it belongs to another interpreter.
+        */
+        int enable_box_cache(long long low, long long high);
+
+        /**
+           Release the objects held by the box cache. This must be called
+           with the GIL held by the interpreter which enabled the cache, in
+           any other interpreter it does nothing.
+        */
+        void disable_box_cache();
+
+        /**
+           Get the statistics of the box cache.
+        */
+        box_cache_info box_cache_stats();
     }
+
+    /**
+       The result of parsing the characters of an integer literal.
+    */
+    struct _parsed_integer_literal {
+        unsigned long long value;
+        bool overflow;
+    };
+
+    /**
+       Parse the characters of a C++ integer literal, including the base
+       prefix and digit separators, at compile time.
+    */
+    template<char... cs>
+    constexpr _parsed_integer_literal _parse_integer_literal() {
+        constexpr char data[] = {cs..., '\0'};
+        unsigned long long base = 10;
+        std::size_t n = 0;
+
+        if (sizeof...(cs) > 1 && data[0] == '0') {
+            if (data[1] == 'x' || data[1] == 'X') {
+                base = 16;
+                n = 2;
+            }
+            else if (data[1] == 'b' || data[1] == 'B') {
+                base = 2;
+                n = 2;
+            }
+            else {
+                base = 8;
+                n = 1;
+            }
+        }
+
+        _parsed_integer_literal out = {0, false};
+        for (; n < sizeof...(cs); ++n) {
+            char c = data[n];
+
+            if (c != '\'') {
+                unsigned long long digit =
+                    (c >= '0' && c <= '9') ? c - '0' :
+                    (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                    c - 'A' + 10;
+
+                if (out.value > (~0ULL - digit) / base) {
+                    out.overflow = true;
+                }
+                out.value = out.value * base + digit;
+            }
+        }
+        return out;
+    }
+
+    template<char... cs>
+    struct _numeric_literal<false, cs...> {
+        using type = long_::object;
+
+        static constexpr _parsed_integer_literal parsed =
+            _parse_integer_literal<cs...>();
+        static_assert(!parsed.overflow,
+                      "integer literal does not fit in unsigned long long");
+
+        static PyObject *make() {
+            return PyLong_FromUnsignedLongLong(parsed.value);
+        }
+    };
+
+    template<char... cs>
+    constexpr _parsed_integer_literal _numeric_literal<false, cs...>::parsed;
 }
@@ -1,11 +1,14 @@
 #pragma once
+#include <exception>
 #include <ostream>
+#include <type_traits>
 
 #include <Python.h>
 
 #include "libpy/utils.h"
 
 #define HAVE_MATMUL (PY_VERSION_HEX >= 0x03500000)
+#define HAVE_VECTORCALL (PY_VERSION_HEX >= 0x03080000)
 
 /**
    A namespace to hold all of the C++ adapted CPython API types, functions, and
@@ -29,6 +32,18 @@ namespace py {
 
     constexpr int PRINT_RAW = Py_PRINT_RAW;
 
+    /**
+       Exception thrown to unwind out of C++ code when a Python exception
+       has already been set. Functions wrapped with `automethod_except` turn
+       this back into the pending Python exception.
+    */
+    class error_already_set : public std::exception {
+    public:
+        const char *what() const noexcept override {
+            return "a Python exception has been set";
+        }
+    };
+
     class object;
 
     // global singletons
@@ -223,6 +238,82 @@ namespace py {
     template<typename T, typename C = object, typename K = object>
     class getitem_result;
 
+    template<typename Name>
+    class keyword_argument;
+
+    template<typename Name, typename T>
+    struct keyword_default;
+
+    /**
+       An inline cache for attribute lookups.
+
+       The cache remembers what `name` resolved to on the type of the last
+       object it was used with. The entry is keyed on the type and its
+       `tp_version_tag` so it is dropped automatically when the type or any
+       of its bases are modified.
+
+       Caches are meant to be declared `static` at the call site:
+
+       @code
+       static py::attr_cache cache;
+       ob.getattr(cache, "name"_p);
+       @endcode
+
+       Types which customize attribute access and names which are not exact
+       `str` objects always use `PyObject_GetAttr`.
+    */
+    class attr_cache {
+    private:
+        enum class kind {
+            /** Defer to `PyObject_GetAttr`. */
+            generic,
+            /** A data descriptor on the type, the instance is not checked. */
+            data_descriptor,
+            /** A non-data descriptor or plain value on the type which may be
+                shadowed by the instance dict. */
+            type_attribute,
+            /** Nothing on the type, check the instance dict. */
+            instance_attribute,
+        };
+
+        PyTypeObject *type;
+        unsigned int version_tag;
+        PyObject *name;
+        PyObject *descr;
+        kind k;
+
+        /**
+           The number of times the interpreter had been finalized when the
+           entry was filled. Caches are usually static so they outlive
+           `Py_Finalize`, the entry is forgotten without decrefing once the
+           interpreter which owns its objects is gone.
+        */
+        unsigned long generation;
+
+        void fill(PyTypeObject *tp, PyObject *name);
+
+    public:
+        attr_cache();
+        attr_cache(const attr_cache&) = delete;
+        attr_cache &operator=(const attr_cache&) = delete;
+        ~attr_cache();
+
+        /**
+           Look up an attribute through the cache.
+
+           @param ob   The object to look up the attribute on.
+           @param name The name of the attribute.
+           @return     A new reference to the attribute or nullptr with an
+                       exception set.
+        */
+        PyObject *getattr(PyObject *ob, PyObject *name);
+
+        /**
+           Drop the cached entry.
+        */
+        void clear();
+    };
+
     /**
        A wrapper around `PyObject*` to provide a C++ interface to the
        CPython API.
@@ -277,11 +368,6 @@ namespace py {
         }
 
     public:
-        friend const object &operator""_p(char c);
-        friend const object &operator""_p(const char *cs, std::size_t len);
-        friend const object &operator""_p(wchar_t c);
-        friend const object &operator""_p(const wchar_t *cs, std::size_t len);
-        friend const object &operator""_p(long double d);
         friend tmpref<object>;
         friend getitem_result<object>;
 
@@ -348,6 +434,25 @@ namespace py {
             return ob_binary_func<PyObject_GetAttr>(attr);
         }
 
+        /**
+           Get an attribute from the object using an inline cache.
+
+           This is equivalent to: `getattr(this, attr)`.
+
+           @see attr_cache
+           @param cache The cache for this call site.
+           @param attr  The name of the attribute as a string object.
+           @return      The value of the attribute.
+        */
+        template<typename T>
+        tmpref<object> getattr(attr_cache &cache, const T &attr) const {
+            if (!pyutils::all_nonnull(*this, attr)) {
+                pyutils::failed_null_check();
+                return nullptr;
+            }
+            return cache.getattr(ob, attr.ob);
+        }
+
         /**
            Sets an attribute on the object.
 
@@ -635,17 +740,23 @@ namespace py {
         bool is(const object &other) const;
 
         // numeric operators
-        template<typename T>
+        template<typename T,
+                 typename = std::enable_if_t<
+                     std::is_base_of<object, T>::value>>
         tmpref<object> operator+(const T &other) const {
             return ob_binary_func<PyNumber_Add>(other);
         }
 
-        template<typename T>
+        template<typename T,
+                 typename = std::enable_if_t<
+                     std::is_base_of<object, T>::value>>
         tmpref<object> operator-(const T &other) const {
             return ob_binary_func<PyNumber_Subtract>(other);
         }
 
-        template<typename T>
+        template<typename T,
+                 typename = std::enable_if_t<
+                     std::is_base_of<object, T>::value>>
         tmpref<object> operator*(const T &other) const {
             return ob_binary_func<PyNumber_Multiply>(other);
         }
@@ -657,7 +768,9 @@ namespace py {
         }
 #endif // CPP_HAVE_MATMUL
 
-        template<typename T>
+        template<typename T,
+                 typename = std::enable_if_t<
+                     std::is_base_of<object, T>::value>>
         tmpref<object> operator/(const T &other) const {
             return ob_binary_func<PyNumber_TrueDivide>(other);
         }
@@ -774,6 +887,9 @@ namespace py {
 
            This is equivalent to: `this(a, b, ...)`.
 
+           When the interpreter supports vectorcall the arguments are passed
+           from the stack and no argument tuple is allocated.
+
            @param args The arguments to to pass to this.
            @return     The result of calling the object with the given
                        arguments.
@@ -781,6 +897,24 @@ namespace py {
         template<typename... Ts>
         tmpref<object> operator()(const Ts&... args) const;
 
+        /**
+           Call a method of the object.
+
+           This is equivalent to: `this.name(a, b, ...)`.
+
+           When `name` resolves to a plain function on the type no bound
+           method object is created; the function is called directly with
+           `this` prepended to the arguments. Instance attributes and other
+           descriptors go through a normal `getattr`.
+
+           @param name The name of the method as a string object.
+           @param args The arguments to to pass to the method.
+           @return     The result of calling the method with the given
+                       arguments.
+        */
+        template<typename T, typename... Ts>
+        tmpref<object> call_method(const T &name, const Ts&... args) const;
+
         /**
            Call an object with a tuple of positional arguments and a mapping
            of keyword arguments.
@@ -873,19 +1007,470 @@ namespace py {
     }
 
 
+    /**
+       A node in the list of every literal used in the program, see
+       `warm_literals` and `clear_literals`.
+    */
+    struct _literal_node {
+        _literal_node *next;
+        int (*fill)();
+        PyObject **slot;
+    };
+
+    /**
+       The head of the list of literals. Literals add themselves when the
+       shared object which uses them is loaded.
+    */
+    extern _literal_node *_literal_registry;
+
+    /**
+       Called before a literal cache slot is filled. This makes sure the
+       caches are reset when the interpreter is finalized and that they are
+       only filled by the interpreter which owns them.
+
+       @return 0 on success, -1 with a `RuntimeError` set if the caches hold
+               objects of another interpreter.
+    */
+    int _literal_claim();
+
+    /**
+       The interpreter whose objects are in the literal caches, or nullptr if
+       the caches are empty.
+    */
+    extern PyInterpreterState *_literal_owner;
+
+    /**
+       Called when a filled literal cache slot is read from an interpreter
+       which does not own the caches.
+
+       @return A reference to a null `PyObject*` with a `RuntimeError` set.
+    */
+    PyObject *const &_literal_foreign();
+
+    /**
+       The cached object for a single literal.
+
+       `Literal` is a type which is unique to the value of the literal and
+       provides `static PyObject *make()`. The slot is a constant
+       initialized `PyObject*` so after the first use a literal costs a
+       load, a null check and a comparison of the caller's interpreter
+       against the owner of the caches. Identical literals in different
+       translation units share the same slot.
+
+       Like CPython's own `_Py_IDENTIFIER` strings, the slots are shared by
+       all interpreters in the process and are reset when the interpreter is
+       finalized so that a new interpreter recreates them. The slots belong
+       to the first interpreter which fills one of them: reading or filling
+       a slot from any other interpreter raises a `RuntimeError` until
+       `clear_literals` is called.
+    */
+    template<typename Literal>
+    struct _literal {
+        static PyObject *ob;
+
+        static int fill() {
+            if (!ob && !_literal_claim()) {
+                ob = Literal::make();
+            }
+            return ob ? 0 : -1;
+        }
+
+        static _literal_node node;
+
+        struct registrar {
+            registrar() {
+                node.next = _literal_registry;
+                _literal_registry = &node;
+            }
+        };
+        static registrar registered;
+
+        template<typename T = object>
+        static inline const T &get() {
+            // instantiate the registrar for every literal that is used
+            (void) &registered;
+
+            if (!ob) {
+                fill();
+            }
+            else if (PyThreadState_Get()->interp != _literal_owner) {
+                return *reinterpret_cast<const T*>(&_literal_foreign());
+            }
+            // `py::object` is a single `PyObject*` so we can view the slot
+            // as an object the same way `PyListObject` storage is viewed
+            return *reinterpret_cast<const T*>(&ob);
+        }
+    };
+
+    template<typename Literal>
+    PyObject *_literal<Literal>::ob = nullptr;
+
+    template<typename Literal>
+    _literal_node _literal<Literal>::node = {
+        nullptr,
+        _literal<Literal>::fill,
+        &_literal<Literal>::ob,
+    };
+
+    template<typename Literal>
+    typename _literal<Literal>::registrar _literal<Literal>::registered;
+
+    /**
+       Create the objects for all of the literals used by the extension
+       modules that have been loaded which have not been created yet.
+
+       Literals are otherwise created the first time they are used. This
+       should be called from the module init function to move that cost out
+       of the first call to each function.
+
+       The literal caches are not per-interpreter. This fails with a
+       `RuntimeError` when it is called from a subinterpreter while the
+       caches hold objects of another interpreter.
+
+       @return 0 on success, -1 with a Python exception set on failure.
+    */
+    int warm_literals();
+
+    /**
+       Release the objects held by the literal and keyword name caches.
+       They will be recreated the next time they are used.
+
+       The caches are reset automatically when the interpreter is finalized.
+       This should be called before the objects become invalid in some other
+       way, for example before ending a subinterpreter which created them,
+       and it releases the caches to be filled by another interpreter.
+       This must be called with the GIL held by the interpreter which
+       filled them.
+    */
+    void clear_literals();
+
+    /**
+       A keyword name known at compile time.
+
+       Instances are created with the `_kw` literal and are assigned a value
+       to create a `keyword_argument`, for example: `f(a, "axis"_kw = b)`.
+    */
+    template<char... cs>
+    struct keyword {
+        static constexpr char name[] = {cs..., '\0'};
+
+        /**
+           Bind a value to this keyword.
+
+           The result only borrows `value` so it must be consumed in the same
+           full expression, normally by passing it to `object::operator()`.
+
+           @param value The value to pass for this keyword.
+           @return      The keyword argument.
+        */
+        keyword_argument<keyword> operator=(const object &value) const {
+            return keyword_argument<keyword>(value);
+        }
+
+        /**
+           Bind a C++ value to this keyword.
+
+           This is used to declare default values for the parameters of
+           functions wrapped with `automethod_kw`.
+
+           @param value The default value for this keyword.
+           @return      The keyword default.
+        */
+        template<typename T,
+                 typename = std::enable_if_t<
+                     !std::is_base_of<object, T>::value>>
+        constexpr keyword_default<keyword, std::decay_t<T>>
+        operator=(const T &value) const {
+            return keyword_default<keyword, std::decay_t<T>>{value};
+        }
+    };
+
+    template<char... cs>
+    constexpr char keyword<cs...>::name[];
+
+    /**
+       A value bound to a compile-time keyword name.
+    */
+    template<typename Name>
+    class keyword_argument {
+    private:
+        PyObject *value;
+
+        explicit keyword_argument(const object &value) : value(value) {}
+
+    public:
+        friend Name;
+
+        inline bool is_nonnull() const {
+            return value;
+        }
+
+        inline PyObject *get() const {
+            return value;
+        }
+    };
+
+    /**
+       A C++ value bound to a compile-time keyword name.
+    */
+    template<typename Name, typename T>
+    struct keyword_default {
+        T value;
+    };
+
+    /**
+       The interned keyword names for a given sequence of `keyword` types.
+
+       The tuple is built the first time a call site with these names is hit
+       and is cached like a literal after that.
+    */
+    template<typename... Names>
+    struct _kwnames {
+        static PyObject *make() {
+            PyObject *names = PyTuple_New(sizeof...(Names));
+            if (!names) {
+                return nullptr;
+            }
+
+            const char *cs[] = {Names::name...};
+            for (std::size_t n = 0; n < sizeof...(Names); ++n) {
+                PyObject *name = PyUnicode_InternFromString(cs[n]);
+                if (!name) {
+                    Py_DECREF(names);
+                    return nullptr;
+                }
+                PyTuple_SET_ITEM(names, n, name);
+            }
+            return names;
+        }
+
+        static inline PyObject *get() {
+            return _literal<_kwnames>::get();
+        }
+    };
+
+    /**
+       Calls without keyword arguments do not need a `kwnames` tuple.
+    */
+    template<>
+    struct _kwnames<> {
+        static inline PyObject *get() {
+            return nullptr;
+        }
+    };
+
+    template<typename Name, typename Names>
+    struct _kwnames_prepend;
+
+    template<typename Name, typename... Names>
+    struct _kwnames_prepend<Name, _kwnames<Names...>> {
+        using type = _kwnames<Name, Names...>;
+    };
+
+    /**
+       Compile time information about the arguments passed to
+       `object::operator()`.
+    */
+    template<typename... Ts>
+    struct _call_traits {
+        static constexpr std::size_t nkwargs = 0;
+        static constexpr bool keywords_last = true;
+        static constexpr bool all_keywords = true;
+        using kwnames = _kwnames<>;
+    };
+
+    template<typename T, typename... Ts>
+    struct _call_traits<T, Ts...> {
+        using tail = _call_traits<Ts...>;
+
+        static constexpr std::size_t nkwargs = tail::nkwargs;
+        static constexpr bool keywords_last = tail::nkwargs == 0 ||
+            tail::keywords_last;
+        static constexpr bool all_keywords = false;
+        using kwnames = typename tail::kwnames;
+    };
+
+    template<typename Name, typename... Ts>
+    struct _call_traits<keyword_argument<Name>, Ts...> {
+        using tail = _call_traits<Ts...>;
+
+        static constexpr std::size_t nkwargs = tail::nkwargs + 1;
+        static constexpr bool keywords_last = tail::all_keywords;
+        static constexpr bool all_keywords = tail::all_keywords;
+        using kwnames = typename _kwnames_prepend<
+            Name,
+            typename tail::kwnames>::type;
+    };
+
+    /**
+       Get the `PyObject*` to pass for a single argument to
+       `object::operator()`.
+    */
+    template<typename T>
+    inline PyObject *_call_arg(const T &arg) {
+        return (PyObject*) arg;
+    }
+
+    template<typename Name>
+    inline PyObject *_call_arg(const keyword_argument<Name> &arg) {
+        return arg.get();
+    }
+
+#if HAVE_VECTORCALL
+    /**
+       Call `callable` with the vectorcall protocol.
+
+       `PyObject_Vectorcall` was named `_PyObject_Vectorcall` in 3.8 so this
+       picks the correct spelling for the interpreter we are building against.
+
+       @param callable The object to call.
+       @param args     The positional arguments followed by the values for
+                       `kwnames`.
+       @param nargsf   The number of positional arguments, optionally or'd
+                       with `PY_VECTORCALL_ARGUMENTS_OFFSET`.
+       @param kwnames  A tuple of keyword names or nullptr.
+       @return         The result of the call.
+    */
+    inline PyObject *_vectorcall(PyObject *callable,
+                                 PyObject *const *args,
+                                 std::size_t nargsf,
+                                 PyObject *kwnames) {
+#if PY_VERSION_HEX >= 0x03090000
+        return PyObject_Vectorcall(callable, args, nargsf, kwnames);
+#else
+        return _PyObject_Vectorcall(callable, args, nargsf, kwnames);
+#endif
+    }
+#endif // HAVE_VECTORCALL
+
+    /**
+       Call `callable` with arguments taken from a stack array by packing
+       them into a `tuple` and `dict`.
+
+       This is the fallback for interpreters without vectorcall.
+
+       @see _stackcall
+    */
+    PyObject *_stackcall_tuple(PyObject *callable,
+                               PyObject *const *args,
+                               std::size_t nargs,
+                               PyObject *kwnames);
+
+    /**
+       Call `callable` with arguments taken from a stack array.
+
+       `args[-1]` must be writable scratch space which the callee may use to
+       prepend `self` without copying the arguments.
+
+       @param callable The object to call.
+       @param args     The positional arguments followed by the values for
+                       `kwnames`.
+       @param nargs    The number of positional arguments.
+       @param kwnames  A tuple of keyword names or nullptr.
+       @return         The result of the call.
+    */
+    inline PyObject *_stackcall(PyObject *callable,
+                                PyObject *const *args,
+                                std::size_t nargs,
+                                PyObject *kwnames) {
+#if HAVE_VECTORCALL
+        return _vectorcall(callable,
+                           args,
+                           nargs | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                           kwnames);
+#else
+        return _stackcall_tuple(callable, args, nargs, kwnames);
+#endif // HAVE_VECTORCALL
+    }
+
+#if PY_VERSION_HEX < 0x03090000
+    /**
+       Look up a method the way the `LOAD_METHOD` opcode does.
+
+       If `name` resolves to a function or method descriptor on the type and
+       is not shadowed by the instance dict then `method` is set to the
+       unbound function so that it can be called with `self` prepended.
+       Otherwise `method` is set to the result of `getattr(self, name)`.
+
+       This is only needed before `PyObject_VectorcallMethod` was added.
+
+       @param self   The object to look up the method on.
+       @param name   The name of the method.
+       @param method Output for a new reference to the method.
+       @return       1 if `method` is unbound, 0 if `method` is bound, or -1
+                     if an exception occured.
+    */
+    int _getmethod(PyObject *self, PyObject *name, PyObject **method);
+#endif
+
     template<typename... Ts>
     tmpref<object> object::operator()(const Ts&... args) const {
+        using traits = _call_traits<Ts...>;
+        static_assert(traits::keywords_last,
+                      "keyword arguments must follow positional arguments");
+
         if (!pyutils::all_nonnull(*this, args...)) {
             pyutils::failed_null_check();
             return nullptr;
         }
 
-        auto pyargs = _tuple_templates::pack(args...);
+        PyObject *kwnames = traits::kwnames::get();
+        if (traits::nkwargs && !kwnames) {
+            return nullptr;
+        }
+
+        /* The arguments are passed from a stack array instead of a tuple.
+           The leading slot is scratch space for the callee. Keyword values
+           follow the positional arguments in the same order as
+           `kwnames`. */
+        PyObject *stack[] = {nullptr, _call_arg(args)...};
+        return _stackcall(ob,
+                          stack + 1,
+                          sizeof...(Ts) - traits::nkwargs,
+                          kwnames);
+    }
+
+    template<typename T, typename... Ts>
+    tmpref<object> object::call_method(const T &name,
+                                       const Ts&... args) const {
+        using traits = _call_traits<Ts...>;
+        static_assert(traits::keywords_last,
+                      "keyword arguments must follow positional arguments");
+
+        if (!pyutils::all_nonnull(*this, name, args...)) {
+            pyutils::failed_null_check();
+            return nullptr;
+        }
+
+        PyObject *kwnames = traits::kwnames::get();
+        if (traits::nkwargs && !kwnames) {
+            return nullptr;
+        }
+
+        constexpr std::size_t nargs = sizeof...(Ts) - traits::nkwargs;
+
+        // scratch slot, then self, then the arguments
+        PyObject *stack[] = {nullptr, ob, _call_arg(args)...};
 
-        if (!pyargs.is_nonnull()) {
+#if PY_VERSION_HEX >= 0x03090000
+        return PyObject_VectorcallMethod(
+            (PyObject*) name,
+            stack + 1,
+            (nargs + 1) | PY_VECTORCALL_ARGUMENTS_OFFSET,
+            kwnames);
+#else
+        PyObject *method;
+        int unbound = _getmethod(ob, (PyObject*) name, &method);
+        tmpref<object> callable(method);
+
+        if (unbound < 0) {
             return nullptr;
         }
-        return PyObject_Call(ob, pyargs.ob, nullptr);
+        if (unbound) {
+            return _stackcall(method, stack + 1, nargs + 1, kwnames);
+        }
+        return _stackcall(method, stack + 2, nargs, kwnames);
+#endif
     }
 
     /**
@@ -1074,16 +1659,76 @@ namespace py {
         };
     }
 
+    inline PyObject *_make_unicode(const char *cs, std::size_t len) {
+        return PyUnicode_FromStringAndSize(cs, len);
+    }
+
+    inline PyObject *_make_unicode(const wchar_t *cs, std::size_t len) {
+        return PyUnicode_FromWideChar(cs, len);
+    }
+
     /**
-       Operator overload for unicode objects.
+       String literals are interned so that attribute and dict lookups with
+       them can hit the pointer comparison fast path.
+    */
+    template<typename C, C... cs>
+    struct _string_literal {
+        static PyObject *make() {
+            static constexpr C data[] = {cs..., C()};
+            PyObject *ob = _make_unicode(data, sizeof...(cs));
+            if (ob) {
+                PyUnicode_InternInPlace(&ob);
+            }
+            return ob;
+        }
+    };
+
+    /**
+       Check if the characters of a numeric literal spell a floating point
+       literal.
+    */
+    template<char... cs>
+    constexpr bool _is_float_literal() {
+        constexpr char data[] = {cs..., '\0'};
+        bool hex = sizeof...(cs) > 1 &&
+            data[0] == '0' &&
+            (data[1] == 'x' || data[1] == 'X');
+
+        for (std::size_t n = 0; n < sizeof...(cs); ++n) {
+            char c = data[n];
+            if (c == '.' ||
+                (hex && (c == 'p' || c == 'P')) ||
+                (!hex && (c == 'e' || c == 'E'))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+       The value of a numeric literal, specialized for integers in
+       `libpy/long.h` and for floats in `libpy/float.h`.
     */
+    template<bool is_float, char... cs>
+    struct _numeric_literal;
 
+    /**
+       Operator overload for unicode objects.
+    */
     const object &operator""_p(char c);
 
     /**
        Operator overload for unicode objects.
+
+       Each distinct literal has its own cached object.
     */
-    const object &operator""_p(const char *cs, std::size_t len);
+    template<typename C, C... cs>
+    inline const object &operator""_p() {
+        static_assert(std::is_same<C, char>::value ||
+                      std::is_same<C, wchar_t>::value,
+                      "only narrow and wide string literals are supported");
+        return _literal<_string_literal<C, cs...>>::get();
+    }
 
     /**
        Operator overload for unicode objects.
@@ -1091,14 +1736,31 @@ namespace py {
     const object &operator""_p(wchar_t c);
 
     /**
-       Operator overload for unicode objects.
+       Operator overload for numeric literals. Integer literals are
+       `long_::object`s, see `libpy/long.h`, and floating point literals are
+       `float` objects.
+
+       Each distinct literal has its own cached object.
     */
-    const object &operator""_p(const wchar_t *cs, std::size_t len);
+    template<char... cs>
+    inline const auto &operator""_p() {
+        using literal = _numeric_literal<_is_float_literal<cs...>(), cs...>;
+        return _literal<literal>::template get<typename literal::type>();
+    }
 
     /**
-       Operator overload for float objects.
+       Operator overload for keyword names.
+
+       This is equivalent to the `name=` part of `f(name=value)` in Python.
+       Each distinct name is its own type so the interned names can be cached
+       per call site.
     */
-    const object &operator""_p(long double d);
+    template<typename C, C... cs>
+    constexpr keyword<cs...> operator""_kw() {
+        static_assert(std::is_same<C, char>::value,
+                      "keyword names must be narrow string literals");
+        return {};
+    }
 
     /**
        ostream writing for objects.
@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace py {
+    /**
+       A non-owning view of a contiguous sequence of `T`.
+
+       This is the subset of C++20's `std::span` with a dynamic extent that
+       libpy needs to hand out zero-copy views of Python buffers.
+    */
+    template<typename T>
+    class span {
+    private:
+        T *ptr;
+        std::size_t count;
+
+    public:
+        typedef T element_type;
+        typedef std::remove_cv_t<T> value_type;
+        typedef T *iterator;
+        typedef T &reference;
+
+        constexpr span() noexcept : ptr(nullptr), count(0) {}
+        constexpr span(T *data, std::size_t size) noexcept :
+            ptr(data),
+            count(size) {}
+
+        template<std::size_t n>
+        constexpr span(T (&array)[n]) noexcept : ptr(array), count(n) {}
+
+        template<typename U,
+                 std::size_t n,
+                 typename = std::enable_if_t<
+                     std::is_convertible<U(*)[], T(*)[]>::value>>
+        constexpr span(std::array<U, n> &array) noexcept :
+            ptr(array.data()),
+            count(n) {}
+
+        template<typename U,
+                 std::size_t n,
+                 typename = std::enable_if_t<
+                     std::is_convertible<const U(*)[], T(*)[]>::value>>
+        constexpr span(const std::array<U, n> &array) noexcept :
+            ptr(array.data()),
+            count(n) {}
+
+        template<typename U,
+                 typename A,
+                 typename = std::enable_if_t<
+                     std::is_convertible<U(*)[], T(*)[]>::value>>
+        span(std::vector<U, A> &vector) noexcept :
+            ptr(vector.data()),
+            count(vector.size()) {}
+
+        template<typename U,
+                 typename A,
+                 typename = std::enable_if_t<
+                     std::is_convertible<const U(*)[], T(*)[]>::value>>
+        span(const std::vector<U, A> &vector) noexcept :
+            ptr(vector.data()),
+            count(vector.size()) {}
+
+        /**
+           Conversion from `span<U>` where `U*` converts to `T*`, for example
+           `span<char>` to `span<const char>`.
+        */
+        template<typename U,
+                 typename = std::enable_if_t<
+                     std::is_convertible<U(*)[], T(*)[]>::value>>
+        constexpr span(const span<U> &other) noexcept :
+            ptr(other.data()),
+            count(other.size()) {}
+
+        constexpr T *data() const noexcept {
+            return ptr;
+        }
+
+        constexpr std::size_t size() const noexcept {
+            return count;
+        }
+
+        constexpr std::size_t size_bytes() const noexcept {
+            return count * sizeof(T);
+        }
+
+        constexpr bool empty() const noexcept {
+            return !count;
+        }
+
+        constexpr iterator begin() const noexcept {
+            return ptr;
+        }
+
+        constexpr iterator end() const noexcept {
+            return ptr + count;
+        }
+
+        constexpr reference operator[](std::size_t idx) const {
+            return ptr[idx];
+        }
+
+        constexpr span first(std::size_t n) const {
+            return {ptr, n};
+        }
+
+        constexpr span last(std::size_t n) const {
+            return {ptr + count - n, n};
+        }
+
+        constexpr span subspan(std::size_t offset, std::size_t n) const {
+            return {ptr + offset, n};
+        }
+
+        constexpr span subspan(std::size_t offset) const {
+            return {ptr + offset, count - offset};
+        }
+    };
+}
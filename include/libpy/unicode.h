@@ -0,0 +1,624 @@
+#pragma once
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#else
+#include <experimental/string_view>
+#endif
+
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "libpy/list.h"
+#include "libpy/object.h"
+#include "libpy/type.h"
+
+// `PyUnicode_READY` is a no-op and deprecated since 3.12
+#define HAVE_UNICODE_READY (PY_VERSION_HEX < 0x030C0000)
+
+namespace py {
+    namespace unicode {
+#if __cplusplus >= 201703L
+        template<typename C>
+        using basic_string_view = std::basic_string_view<C>;
+#else
+        template<typename C>
+        using basic_string_view = std::experimental::basic_string_view<C>;
+#endif
+
+        using string_view = basic_string_view<char>;
+
+        /**
+           A subclass of `py::object` for optional `str` objects.
+        */
+        class object : public py::object {
+        private:
+            /**
+               Function called to verify that `ob` is a str and
+               correctly raise a python exception otherwise.
+            */
+            void unicode_check();
+
+            /**
+               Check that `ob` is nonnull, ready, and stores its characters
+               with the given kind.
+            */
+            bool check_kind(int expected) const;
+
+        public:
+            friend class py::tmpref<object>;
+            friend class py::getitem_result<object>;
+
+            /**
+               Default constructor. This will set `ob` to nullptr.
+            */
+            object();
+
+            /**
+               Constructor from `PyObject*`. If `pob` is not a `str` then
+               `ob` will be set to `nullptr`.
+            */
+            object(PyObject *pob);
+
+            /**
+               Constructor from `py::object`. If `pob` is not a `str` then
+               `ob` will be set to `nullptr`.
+            */
+            object(const py::object &pob);
+
+            object(const object &cpfrom);
+            object(object &&mvfrom) noexcept;
+
+            using py::object::operator=;
+
+            /**
+               Get the length of the object in code points.
+
+               This is equivalent to `len(this)`.
+
+               @return The length of the object or -1 if an exception occured.
+            */
+            py::ssize_t len() const;
+
+            /**
+               Get the storage kind of the object.
+
+               @return `PyUnicode_1BYTE_KIND`, `PyUnicode_2BYTE_KIND`, or
+                       `PyUnicode_4BYTE_KIND`, or -1 if an exception occured.
+            */
+            int kind() const;
+
+            /**
+               View the UTF-8 representation of the object.
+
+               The UTF-8 representation is cached on the object the first
+               time it is requested, and for ASCII strings it is the
+               character storage itself, so this does not copy. The view is
+               valid for as long as the object is alive.
+
+               @return The UTF-8 bytes of the object. If an exception occured
+                       the view's `data()` is nullptr.
+            */
+            string_view as_string_view() const;
+
+            /**
+               View the characters of an object with
+               `kind() == PyUnicode_1BYTE_KIND`. This is latin-1.
+
+               @return The characters of the object. If an exception occured,
+                       including if the object has a different kind, the
+                       view's `data()` is nullptr.
+            */
+            basic_string_view<Py_UCS1> as_ucs1() const;
+
+            /**
+               View the characters of an object with
+               `kind() == PyUnicode_2BYTE_KIND`.
+
+               @see as_ucs1
+            */
+            basic_string_view<Py_UCS2> as_ucs2() const;
+
+            /**
+               View the characters of an object with
+               `kind() == PyUnicode_4BYTE_KIND`.
+
+               @see as_ucs1
+            */
+            basic_string_view<Py_UCS4> as_ucs4() const;
+
+            /**
+               Read the code point at `idx` without bounds or null checking.
+               The object must be ready, which is true after any successful
+               call to `len` or `kind`.
+
+               @param idx The index of the code point.
+               @return    The code point at `idx`.
+            */
+            Py_UCS4 read_char(py::ssize_t idx) const;
+
+            /**
+               Read the code point at `idx` with bounds checking.
+
+               @param idx The index of the code point.
+               @return    The code point at `idx` or `(Py_UCS4) -1` with a
+                          Python `IndexError` set if `idx` is out of range.
+            */
+            Py_UCS4 read_char_checked(py::ssize_t idx) const;
+
+            // The string methods below search the character storage directly
+            // with SSE2 or AVX2, picked at runtime, when both strings are
+            // stored with `PyUnicode_1BYTE_KIND`. Other strings are handed to
+            // the CPython implementation.
+
+            /**
+               Find the first occurrence of a substring.
+
+               This is equivalent to `this.find(sub)`.
+
+               @param sub The substring to search for.
+               @return    The index of the first occurrence of `sub`, -1 if
+                          `sub` does not appear, or -2 if an exception
+                          occured.
+            */
+            py::ssize_t find(const py::object &sub) const;
+
+            /**
+               Count the non-overlapping occurrences of a substring.
+
+               This is equivalent to `this.count(sub)`.
+
+               @param sub The substring to count.
+               @return    The number of occurrences of `sub` or -1 if an
+                          exception occured.
+            */
+            py::ssize_t count(const py::object &sub) const;
+
+            /**
+               Check if the object starts with a prefix.
+
+               This is equivalent to `this.startswith(prefix)`.
+
+               @param prefix The prefix to check for.
+               @return       1 if the object starts with `prefix`, 0 if it
+                             does not, or -1 if an exception occured.
+            */
+            int startswith(const py::object &prefix) const;
+
+            /**
+               Split the object on a separator.
+
+               This is equivalent to `this.split(sep, maxsplit)`. The result
+               list is allocated once at its final size.
+
+               @param sep      The separator to split on.
+               @param maxsplit The maximum number of splits to do, or -1 for
+                               no limit.
+               @return         The pieces of the object.
+            */
+            tmpref<py::list::object> split(const py::object &sep,
+                                           py::ssize_t maxsplit = -1) const;
+
+            /**
+               Split the object on runs of whitespace.
+
+               This is equivalent to `this.split()`.
+
+               @return The pieces of the object.
+            */
+            tmpref<py::list::object> split() const;
+
+            /**
+               Remove leading and trailing whitespace.
+
+               This is equivalent to `this.strip()`.
+
+               @return The stripped object.
+            */
+            tmpref<object> strip() const;
+
+            /**
+               Coerce to a `nonnull` object.
+
+               @see nonnull
+               @throws pyutil::bad_nonnull Thrown when `ob == nullptr`.
+               @return this converted to a `nonnull` object.
+            */
+            nonnull<object> as_nonnull() const;
+
+            /**
+               Create a temporary reference. This is a reference that will
+               decref the object when it is destroyed.
+
+               @return this converted into a tmpref.
+            */
+            tmpref<object> as_tmpref() &&;
+        };
+
+        /**
+           The type of Python `str` objects.
+
+           This is equivalent to: `str`.
+        */
+        extern const type::object<unicode::object> type;
+
+        /**
+           Check if an object is an instance of `str`.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `str`, 0 if `ob` is not an
+                    instance of `str`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int check(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyUnicode_Check((PyObject*) t);
+        }
+
+        inline int check(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Check if an object is an instance of `str` but not a subclass.
+
+           @param t The object to check
+           @return  1 if `ob` is an instance of `str`, 0 if `ob` is not an
+                    instance of `str`, -1 if an exception occured.
+        */
+        template<typename T>
+        inline int checkexact(const T &t) {
+            if (!t.is_nonnull()) {
+                pyutils::failed_null_check();
+                return -1;
+            }
+            return PyUnicode_CheckExact((PyObject*) t);
+        }
+
+        inline int checkexact(const nonnull<object>&) {
+            return 1;
+        }
+
+        /**
+           Build a `str` out of pieces with a single allocation.
+
+           Pieces are collected until `build` is called, while the total
+           length and the widest character kind are tracked. `build` then
+           allocates the result at its final size and kind and copies each
+           piece into it once, instead of creating a temporary for every
+           concatenation.
+
+           @code
+           py::unicode::builder b;
+           b.append("row ").append(ix).append(": ").append(ob);
+           auto row = b.build();
+           @endcode
+
+           Like the rest of libpy, errors do not need to be checked between
+           calls. The first failure is remembered and `build` returns
+           nullptr with the Python exception set.
+        */
+        class builder {
+        private:
+            /**
+               A `str` to copy, or when `ob` is nullptr, a run of ASCII
+               characters in `text`.
+            */
+            struct piece {
+                PyObject *ob;
+                std::size_t offset;
+                py::ssize_t size;
+            };
+
+            std::vector<piece> pieces;
+            std::string text;
+            py::ssize_t length;
+            Py_UCS4 maxchar;
+            bool failed;
+
+            builder &append_ascii(const char *cs, std::size_t size);
+            builder &append_owned(PyObject *ob);
+
+        public:
+            builder();
+            builder(const builder&) = delete;
+            builder &operator=(const builder&) = delete;
+            ~builder();
+
+            /**
+               Reserve space for `size` pieces.
+            */
+            builder &reserve(std::size_t size);
+
+            /**
+               Append `str(ob)`. `str` objects are not copied until `build`.
+            */
+            builder &append(const py::object &ob);
+
+            builder &append(PyObject *ob) {
+                return append(py::object(ob));
+            }
+
+            /**
+               Other pointers are rejected instead of converting to `bool`.
+            */
+            template<typename T,
+                     typename = std::enable_if_t<
+                         !std::is_same<std::remove_cv_t<T>, char>::value>>
+            builder &append(T*) = delete;
+
+            /**
+               Append UTF-8 encoded characters.
+            */
+            builder &append(const char *cs, std::size_t size);
+            builder &append(const char *cs);
+            builder &append(const std::string &cs);
+            builder &append(string_view cs);
+
+            /**
+               Append a single character.
+            */
+            builder &append(char c);
+
+            /**
+               Append `'True'` or `'False'`.
+            */
+            builder &append(bool b);
+
+            /**
+               Append the decimal representation of an integer.
+            */
+            builder &append(long long i);
+            builder &append(unsigned long long i);
+
+            template<typename I,
+                     typename = std::enable_if_t<std::is_integral<I>::value>>
+            builder &append(I i) {
+                if (std::is_signed<I>::value) {
+                    return append(static_cast<long long>(i));
+                }
+                return append(static_cast<unsigned long long>(i));
+            }
+
+            /**
+               Append the same representation as `str(d)`.
+            */
+            builder &append(double d);
+
+            /**
+               The length in code points of the pieces appended so far.
+            */
+            py::ssize_t len() const {
+                return length;
+            }
+
+            /**
+               Create the `str` and reset the builder.
+
+               @return The concatenation of the appended pieces or nullptr if
+                       any append failed.
+            */
+            tmpref<object> build();
+        };
+
+        /**
+           A format string which is parsed at compile time.
+
+           Replacement fields are written as `{}` and are filled in order;
+           `{{` and `}}` produce literal braces. Format specs, indices, and
+           names are not supported. Arguments may be anything that can be
+           passed to `builder::append`.
+
+           Instances are created with `py::operator""_fmt`.
+        */
+        template<char... cs>
+        class format_string {
+        private:
+            static constexpr std::size_t length = sizeof...(cs);
+            static constexpr char data[length + 1] = {cs..., '\0'};
+
+            /**
+               A run of literal characters, optionally followed by a
+               replacement field.
+            */
+            struct segment {
+                std::size_t begin;
+                std::size_t end;
+                bool field;
+            };
+
+            struct parsed_format {
+                segment segments[length + 1];
+                std::size_t count;
+                std::size_t fields;
+                bool valid;
+            };
+
+            static constexpr parsed_format parse() {
+                parsed_format out{{}, 0, 0, true};
+                std::size_t begin = 0;
+                std::size_t ix = 0;
+                while (ix < length) {
+                    char c = data[ix];
+                    char next = (ix + 1 < length) ? data[ix + 1] : '\0';
+                    if ((c == '{' && next == '{') ||
+                        (c == '}' && next == '}')) {
+                        out.segments[out.count++] = {begin, ix + 1, false};
+                        ix += 2;
+                        begin = ix;
+                    }
+                    else if (c == '{' && next == '}') {
+                        out.segments[out.count++] = {begin, ix, true};
+                        ++out.fields;
+                        ix += 2;
+                        begin = ix;
+                    }
+                    else if (c == '{' || c == '}') {
+                        out.valid = false;
+                        ix = length;
+                    }
+                    else {
+                        ++ix;
+                    }
+                }
+                out.segments[out.count++] = {begin, length, false};
+                return out;
+            }
+
+            static constexpr parsed_format parsed = parse();
+
+            static constexpr std::size_t field_index(std::size_t segment) {
+                std::size_t out = 0;
+                for (std::size_t ix = 0; ix < segment; ++ix) {
+                    out += parsed.segments[ix].field;
+                }
+                return out;
+            }
+
+            template<std::size_t ix, typename Args>
+            static void append_field(builder&,
+                                     const Args&,
+                                     std::false_type) {}
+
+            template<std::size_t ix, typename Args>
+            static void append_field(builder &b,
+                                     const Args &args,
+                                     std::true_type) {
+                b.append(std::get<ix>(args));
+            }
+
+            template<std::size_t ix, typename Args>
+            static void append_segment(builder &b, const Args &args) {
+                constexpr segment s = parsed.segments[ix];
+                if (s.end != s.begin) {
+                    b.append(data + s.begin, s.end - s.begin);
+                }
+                append_field<field_index(ix)>(
+                    b,
+                    args,
+                    std::integral_constant<bool, s.field>{});
+            }
+
+            template<typename Args, std::size_t... ixs>
+            static void append_segments(builder &b,
+                                        const Args &args,
+                                        std::index_sequence<ixs...>) {
+                (void) std::initializer_list<int> {
+                    (append_segment<ixs>(b, args), 0)...
+                };
+            }
+
+        public:
+            /**
+               Format the arguments into a new `str`.
+
+               @param args The values for the replacement fields.
+               @return     The formatted string.
+            */
+            template<typename... Args>
+            tmpref<object> operator()(const Args&... args) const {
+                static_assert(parsed.valid,
+                              "unmatched brace in format string, only '{}', "
+                              "'{{', and '}}' are supported");
+                static_assert(parsed.fields == sizeof...(Args),
+                              "wrong number of arguments for format string");
+
+                builder b;
+                b.reserve(parsed.count + sizeof...(Args));
+                append_segments(b,
+                                std::forward_as_tuple(args...),
+                                std::make_index_sequence<parsed.count>{});
+                return b.build();
+            }
+        };
+
+        template<char... cs>
+        constexpr char format_string<cs...>::data[];
+
+        template<char... cs>
+        constexpr typename format_string<cs...>::parsed_format
+        format_string<cs...>::parsed;
+    }
+
+    /**
+       A `py::unicode::object` where `ob` is known to be nonnull and ready.
+       This is used to skip null checks for performance.
+
+       This class should be used where users want to trade the ability to
+       write a nested expression for perfomance.
+    */
+    template<>
+    class nonnull<unicode::object> : public unicode::object {
+    protected:
+        nonnull() = delete;
+        explicit nonnull(PyObject *ob) : unicode::object(ob) {}
+
+    public:
+        friend class unicode::object;
+
+        nonnull(const nonnull &cpfrom) : unicode::object(cpfrom) {}
+        nonnull(nonnull &&mvfrom) noexcept :
+            unicode::object((PyObject*) mvfrom) {
+            mvfrom.ob = nullptr;
+        }
+
+        nonnull &operator=(const nonnull &cpfrom) {
+            nonnull<unicode::object> tmp(cpfrom);
+            return (*this = std::move(tmp));
+        }
+
+        nonnull &operator=(nonnull &&mvfrom) noexcept {
+            ob = mvfrom.ob;
+            mvfrom.ob = nullptr;
+            return *this;
+        }
+
+        /**
+           Get the length of the object in code points.
+
+           This is equivalent to `len(this)`.
+        */
+        py::ssize_t len() const {
+            return PyUnicode_GET_LENGTH(ob);
+        }
+
+        /**
+           Get the storage kind of the object.
+        */
+        int kind() const {
+            return PyUnicode_KIND(ob);
+        }
+
+        /**
+           Read the code point at `idx` without bounds checking.
+        */
+        Py_UCS4 read_char(py::ssize_t idx) const {
+            return PyUnicode_READ(PyUnicode_KIND(ob),
+                                  PyUnicode_DATA(ob),
+                                  idx);
+        }
+    };
+
+    /**
+       Create a compile time parsed format string.
+
+       @code
+       "{}: {}"_fmt(name, value)
+       @endcode
+
+       @see py::unicode::format_string
+    */
+    template<typename C, C... cs>
+    constexpr unicode::format_string<cs...> operator""_fmt() {
+        static_assert(std::is_same<C, char>::value,
+                      "format strings must be narrow string literals");
+        return {};
+    }
+}
@@ -0,0 +1,94 @@
+// this header is included once per instruction set inside a namespace which
+// provides `reg`, `width`, `splat`, `load`, and `eq_mask` so that the kernels
+// are compiled with that instruction set enabled
+
+/**
+   Find the first occurrence of a byte.
+
+   @param begin The start of the buffer to search.
+   @param end   The end of the buffer to search.
+   @param c     The byte to search for.
+   @return      A pointer to the first occurrence of `c` or `end` if `c` does
+                not appear.
+*/
+const char *find_byte(const char *begin, const char *end, char c) {
+    const reg needle = splat(c);
+    for (; end - begin >= width; begin += width) {
+        std::uint32_t mask = eq_mask(load(begin), needle);
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    for (; begin < end; ++begin) {
+        if (*begin == c) {
+            return begin;
+        }
+    }
+    return end;
+}
+
+/**
+   Count the occurrences of a byte.
+
+   @param begin The start of the buffer to search.
+   @param end   The end of the buffer to search.
+   @param c     The byte to count.
+   @return      The number of times `c` appears in `[begin, end)`.
+*/
+py::ssize_t count_byte(const char *begin, const char *end, char c) {
+    const reg needle = splat(c);
+    py::ssize_t count = 0;
+    for (; end - begin >= width; begin += width) {
+        count += __builtin_popcount(eq_mask(load(begin), needle));
+    }
+    for (; begin < end; ++begin) {
+        count += *begin == c;
+    }
+    return count;
+}
+
+/**
+   Find the first occurrence of a substring of at least two bytes.
+
+   Candidates are found by comparing the first and last byte of the needle
+   against a full register of positions at once; only those are checked with
+   `memcmp`.
+
+   @param begin  The start of the buffer to search.
+   @param end    The end of the buffer to search.
+   @param needle The substring to search for.
+   @param size   The length of `needle`, at least 2.
+   @return       A pointer to the first occurrence of `needle` or `end` if
+                 `needle` does not appear.
+*/
+const char *find(const char *begin,
+                 const char *end,
+                 const char *needle,
+                 py::ssize_t size) {
+    if (end - begin < size) {
+        return end;
+    }
+
+    const reg first = splat(needle[0]);
+    const reg last = splat(needle[size - 1]);
+    // one past the last position a match could start at
+    const char *stop = end - size + 1;
+    const char *p = begin;
+    for (; stop - p >= width; p += width) {
+        std::uint32_t mask = (eq_mask(load(p), first) &
+                              eq_mask(load(p + size - 1), last));
+        while (mask) {
+            const char *candidate = p + __builtin_ctz(mask);
+            if (!std::memcmp(candidate + 1, needle + 1, size - 2)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    for (; p < stop; ++p) {
+        if (*p == needle[0] && !std::memcmp(p + 1, needle + 1, size - 1)) {
+            return p;
+        }
+    }
+    return end;
+}
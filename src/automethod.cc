@@ -0,0 +1,172 @@
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <Python.h>
+
+#include "libpy/automethod.h"
+
+void pyutils::_raise_bad_arity(std::size_t arity, Py_ssize_t nargs) {
+    PyErr_Format(PyExc_TypeError,
+                 "function takes exactly %zu argument%s (%zd given)",
+                 arity,
+                 arity == 1 ? "" : "s",
+                 nargs);
+}
+
+void pyutils::_raise_too_many_positional(std::size_t arity, Py_ssize_t nargs) {
+    PyErr_Format(PyExc_TypeError,
+                 "function takes at most %zu positional argument%s "
+                 "(%zd given)",
+                 arity,
+                 arity == 1 ? "" : "s",
+                 nargs);
+}
+
+void pyutils::_raise_missing_argument(PyObject *names, std::size_t ix) {
+    PyErr_Format(PyExc_TypeError,
+                 "function missing required argument '%U' (pos %zu)",
+                 PyTuple_GET_ITEM(names, ix),
+                 ix + 1);
+}
+
+/**
+   Find the index of `key` in `names` or -1 if it is not a parameter name.
+*/
+static Py_ssize_t keyword_index(PyObject *names, PyObject *key) {
+    Py_ssize_t size = PyTuple_GET_SIZE(names);
+
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        if (PyTuple_GET_ITEM(names, ix) == key) {
+            return ix;
+        }
+    }
+
+    if (!PyUnicode_Check(key)) {
+        return -1;
+    }
+    for (Py_ssize_t ix = 0; ix < size; ++ix) {
+        if (!PyUnicode_Compare(PyTuple_GET_ITEM(names, ix), key)) {
+            return ix;
+        }
+    }
+    return -1;
+}
+
+/**
+   Store `value` into the slot for `key`, raising a `TypeError` if `key` is
+   unknown or already has a value.
+*/
+static bool bind_keyword(PyObject *names,
+                         PyObject **slots,
+                         Py_ssize_t nargs,
+                         PyObject *key,
+                         PyObject *value) {
+    Py_ssize_t ix = keyword_index(names, key);
+
+    if (ix < 0) {
+        if (PyUnicode_Check(key)) {
+            PyErr_Format(PyExc_TypeError,
+                         "'%U' is an invalid keyword argument for this "
+                         "function",
+                         key);
+        }
+        else {
+            PyErr_SetString(PyExc_TypeError, "keywords must be strings");
+        }
+        return false;
+    }
+    if (ix < nargs) {
+        PyErr_Format(PyExc_TypeError,
+                     "argument for function given by name ('%U') and "
+                     "position (%zd)",
+                     key,
+                     ix + 1);
+        return false;
+    }
+    if (slots[ix]) {
+        PyErr_Format(PyExc_TypeError,
+                     "function got multiple values for argument '%U'",
+                     key);
+        return false;
+    }
+    slots[ix] = value;
+    return true;
+}
+
+bool pyutils::_bind_keywords(PyObject *names,
+                             PyObject **slots,
+                             Py_ssize_t nargs,
+                             PyObject *const *kwvalues,
+                             PyObject *kwnames) {
+    Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
+
+    for (Py_ssize_t n = 0; n < nkwargs; ++n) {
+        if (!bind_keyword(names,
+                          slots,
+                          nargs,
+                          PyTuple_GET_ITEM(kwnames, n),
+                          kwvalues[n])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pyutils::_bind_keywords_dict(PyObject *names,
+                                  PyObject **slots,
+                                  Py_ssize_t nargs,
+                                  PyObject *kwargs) {
+    Py_ssize_t pos = 0;
+    PyObject *key;
+    PyObject *value;
+
+    while (PyDict_Next(kwargs, &pos, &key, &value)) {
+        if (!bind_keyword(names, slots, nargs, key, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void pyutils::_translate_exception() {
+    try {
+        throw;
+    }
+    catch (const py::error_already_set&) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_SystemError,
+                            "error_already_set thrown without an exception "
+                            "set");
+        }
+    }
+    catch (const pyutils::bad_nonnull&) {
+        pyutils::failed_null_check();
+    }
+    catch (const std::bad_alloc&) {
+        PyErr_NoMemory();
+    }
+    catch (const std::out_of_range &e) {
+        PyErr_SetString(PyExc_IndexError, e.what());
+    }
+    catch (const std::exception &e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
+    catch (...) {
+        PyErr_SetString(PyExc_SystemError, "unknown C++ exception");
+    }
+}
+
+void pyutils::_raise_no_overload(PyObject *const *args, Py_ssize_t nargs) {
+    std::string types;
+
+    for (Py_ssize_t n = 0; n < nargs; ++n) {
+        if (n) {
+            types += ", ";
+        }
+        types += Py_TYPE(args[n])->tp_name;
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "no overload of function matches the arguments (%s)",
+                 types.c_str());
+}
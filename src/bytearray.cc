@@ -0,0 +1,78 @@
+#include "libpy/bytearray.h"
+#include "libpy/utils.h"
+
+namespace ba = py::bytearray;
+
+// `PyByteArray_Type` is statically allocated so this is valid in every
+// interpreter
+const py::type::object<ba::object> ba::type((PyObject*) &PyByteArray_Type);
+
+ba::object::object() : py::object() {}
+
+ba::object::object(py::span<const char> data) :
+    py::object(PyByteArray_FromStringAndSize(data.data(), data.size())) {}
+
+ba::object::object(PyObject *pob) : py::object(pob) {
+    bytearray_check();
+}
+
+ba::object::object(const py::object &pob) : py::object(pob) {
+    bytearray_check();
+}
+
+ba::object::object(const ba::object &cpfrom) :
+    py::object((PyObject*) cpfrom) {}
+
+ba::object::object(ba::object &&mvfrom) noexcept :
+    py::object((PyObject*) mvfrom) {
+    mvfrom.ob = nullptr;
+}
+
+void ba::object::bytearray_check() {
+    if (ob && !PyByteArray_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(
+                PyExc_TypeError,
+                "cannot make py::bytearray::object from non bytearray");
+        }
+    }
+}
+
+py::ssize_t ba::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyByteArray_GET_SIZE(ob);
+}
+
+py::span<char> ba::object::as_span() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return {};
+    }
+    return {PyByteArray_AS_STRING(ob),
+            static_cast<std::size_t>(PyByteArray_GET_SIZE(ob))};
+}
+
+int ba::object::resize(py::ssize_t size) {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyByteArray_Resize(ob, size);
+}
+
+py::nonnull<ba::object> ba::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<ba::object>(ob);
+}
+
+py::tmpref<ba::object> ba::object::as_tmpref() && {
+    tmpref<ba::object> ret(ob);
+    ob = nullptr;
+    return std::move(ret);
+}
@@ -0,0 +1,157 @@
+#include <cstring>
+
+#include "libpy/bytes.h"
+#include "libpy/utils.h"
+
+namespace b = py::bytes;
+
+// `PyBytes_Type` is statically allocated so this is valid in every
+// interpreter
+const py::type::object<b::object> b::type((PyObject*) &PyBytes_Type);
+
+b::object::object() : py::object() {}
+
+b::object::object(py::span<const char> data) :
+    py::object(PyBytes_FromStringAndSize(data.data(), data.size())) {}
+
+b::object::object(PyObject *pob) : py::object(pob) {
+    bytes_check();
+}
+
+b::object::object(const py::object &pob) : py::object(pob) {
+    bytes_check();
+}
+
+b::object::object(const b::object &cpfrom) :
+    py::object((PyObject*) cpfrom) {}
+
+b::object::object(b::object &&mvfrom) noexcept :
+    py::object((PyObject*) mvfrom) {
+    mvfrom.ob = nullptr;
+}
+
+void b::object::bytes_check() {
+    if (ob && !PyBytes_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::bytes::object from non bytes");
+        }
+    }
+}
+
+py::ssize_t b::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return PyBytes_GET_SIZE(ob);
+}
+
+py::span<const char> b::object::as_span() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return {};
+    }
+    return {PyBytes_AS_STRING(ob),
+            static_cast<std::size_t>(PyBytes_GET_SIZE(ob))};
+}
+
+py::nonnull<b::object> b::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<b::object>(ob);
+}
+
+py::tmpref<b::object> b::object::as_tmpref() && {
+    tmpref<b::object> ret(ob);
+    ob = nullptr;
+    return std::move(ret);
+}
+
+b::writer::writer(py::ssize_t capacity) :
+    ob(nullptr),
+    size(0),
+    failed(false) {
+    // the empty bytes object is a shared singleton which cannot be resized
+    // so we always allocate at least one byte
+    ob = PyBytes_FromStringAndSize(nullptr, capacity > 0 ? capacity : 1);
+    failed = !ob;
+}
+
+b::writer::~writer() {
+    Py_XDECREF(ob);
+}
+
+bool b::writer::grow(py::ssize_t n) {
+    if (failed) {
+        return false;
+    }
+    if (!ob) {
+        // reused after `finish`
+        ob = PyBytes_FromStringAndSize(nullptr, n > 256 ? n : 256);
+        failed = !ob;
+        return ob;
+    }
+
+    py::ssize_t capacity = PyBytes_GET_SIZE(ob);
+    if (capacity - size >= n) {
+        return true;
+    }
+    if (n > PY_SSIZE_T_MAX - size) {
+        PyErr_NoMemory();
+        Py_CLEAR(ob);
+        failed = true;
+        return false;
+    }
+
+    py::ssize_t needed = size + n;
+    py::ssize_t new_capacity = (capacity <= PY_SSIZE_T_MAX / 2) ?
+        capacity * 2 :
+        PY_SSIZE_T_MAX;
+    if (new_capacity < needed) {
+        new_capacity = needed;
+    }
+    // `_PyBytes_Resize` reallocates in place because we hold the only
+    // reference, on failure it clears `ob`
+    failed = _PyBytes_Resize(&ob, new_capacity);
+    return !failed;
+}
+
+b::writer &b::writer::commit(py::ssize_t n) {
+    if (!failed) {
+        size += n;
+    }
+    return *this;
+}
+
+b::writer &b::writer::write_slow(const char *data, py::ssize_t n) {
+    if (grow(n)) {
+        std::memcpy(PyBytes_AS_STRING(ob) + size, data, n);
+        size += n;
+    }
+    return *this;
+}
+
+py::tmpref<b::object> b::writer::finish() {
+    PyObject *out = ob;
+    py::ssize_t written = size;
+    bool was_failed = failed;
+    ob = nullptr;
+    size = 0;
+    failed = false;
+
+    if (was_failed) {
+        Py_XDECREF(out);
+        return nullptr;
+    }
+    if (!out) {
+        // nothing was written since the last `finish`
+        return PyBytes_FromStringAndSize(nullptr, 0);
+    }
+    if (written != PyBytes_GET_SIZE(out) && _PyBytes_Resize(&out, written)) {
+        return nullptr;
+    }
+    return out;
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <utility>
+
+#include "libpy/float.h"
+#include "libpy/utils.h"
+
+namespace f = py::float_;
+
+// `PyFloat_Type` is statically allocated so this is valid in every
+// interpreter
+const py::type::object<f::object> f::type((PyObject*) &PyFloat_Type);
+
+f::object::object() : py::object() {}
+
+f::object::object(double d) : py::object(PyFloat_FromDouble(d)) {}
+
+f::object::object(PyObject *pob) : py::object(pob) {
+    float_check();
+}
+
+f::object::object(const py::object &pob) : py::object(pob) {
+    float_check();
+}
+
+f::object::object(const f::object &cpfrom) :
+    py::object((PyObject*) cpfrom) {}
+
+f::object::object(f::object &&mvfrom) noexcept :
+    py::object((PyObject*) mvfrom) {
+    mvfrom.ob = nullptr;
+}
+
+void f::object::float_check() {
+    if (ob && !PyFloat_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::float_::object from non float");
+        }
+    }
+}
+
+double f::object::as_double() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1.0;
+    }
+    if (PyFloat_CheckExact(ob)) {
+        return PyFloat_AS_DOUBLE(ob);
+    }
+    return PyFloat_AsDouble(ob);
+}
+
+py::nonnull<f::object> f::object::as_nonnull() const {
+    if (!is_nonnull()) {
+        throw pyutils::bad_nonnull();
+    }
+    return py::nonnull<f::object>(ob);
+}
+
+py::tmpref<f::object> f::object::as_tmpref() && {
+    py::tmpref<object> ret(ob);
+    ob = nullptr;
+    return std::move(ret);
+}
+
+py::tmpref<f::object> f::object::operator-() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (PyFloat_CheckExact(ob)) {
+        return PyFloat_FromDouble(-PyFloat_AS_DOUBLE(ob));
+    }
+    return PyNumber_Negative(ob);
+}
+
+py::tmpref<f::object> f::object::operator+() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (PyFloat_CheckExact(ob)) {
+        // `+x` is `x` for exact floats
+        Py_INCREF(ob);
+        return ob;
+    }
+    return PyNumber_Positive(ob);
+}
+
+py::tmpref<f::object> f::object::abs() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (PyFloat_CheckExact(ob)) {
+        return PyFloat_FromDouble(std::fabs(PyFloat_AS_DOUBLE(ob)));
+    }
+    return PyNumber_Absolute(ob);
+}
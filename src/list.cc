@@ -3,6 +3,7 @@
 
 namespace l = py::list;
 
+// `PyList_Type` is statically allocated so this is valid in every interpreter
 const py::type::object<l::object> l::type((PyObject*) &PyList_Type);
 
 l::object::object() : py::object() {}
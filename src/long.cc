@@ -1,18 +1,9 @@
-#include <unordered_map>
+#include <climits>
 #include <utility>
 
 #include "libpy/long.h"
 #include "libpy/utils.h"
 
-const py::long_::object &py::operator""_p(unsigned long long l) {
-    static std::unordered_map<unsigned long long, py::long_::object> cache;
-    py::long_::object &ob = cache[l];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyLong_FromUnsignedLongLong(l);
-    }
-    return ob;
-}
-
 py::long_::object::object() : py::object(nullptr) {}
 
 py::long_::object::object(PyObject *pob) : py::object(pob) {
@@ -23,6 +14,13 @@ py::long_::object::object(const py::object &pob) : py::object(pob) {
     long_check();
 }
 
+#if HAVE_INT128
+py::long_::object::object(__int128 l) : py::object(_box_integer(l)) {}
+
+py::long_::object::object(unsigned __int128 l) :
+    py::object(_box_integer(l)) {}
+#endif
+
 py::long_::object::object(const py::long_::object &cpfrom) :
     py::object((PyObject*) cpfrom) {}
 
@@ -78,6 +76,36 @@ double py::long_::object::as_double() const {
     return as_t<double, PyLong_AsDouble>();
 }
 
+#if HAVE_INT128
+__int128 py::long_::object::as_int128() const {
+    __int128 out;
+    if (as_bytes(span<char>(reinterpret_cast<char*>(&out), sizeof(out)))) {
+        return -1;
+    }
+    return out;
+}
+
+unsigned __int128 py::long_::object::as_uint128() const {
+    unsigned __int128 out;
+    if (as_bytes(span<char>(reinterpret_cast<char*>(&out), sizeof(out)),
+                 byteorder::native,
+                 false)) {
+        return -1;
+    }
+    return out;
+}
+#endif
+
+int py::long_::object::as_bytes(py::span<char> out,
+                                byteorder order,
+                                bool is_signed) const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    return _as_byte_array(ob, out.data(), out.size(), order, is_signed);
+}
+
 py::nonnull<py::long_::object> py::long_::object::as_nonnull() const {
     if (!is_nonnull()) {
         throw pyutils::bad_nonnull();
@@ -91,18 +119,258 @@ py::tmpref<py::long_::object> py::long_::object::as_tmpref() && {
     return std::move(ret);
 }
 
+namespace {
+    /**
+       Read `ob` as a machine word if it is an exact `int` which fits in one.
+    */
+    bool as_word(PyObject *ob, long long &out) {
+        return ob && PyLong_CheckExact(ob) && py::long_::_as_word(ob, out);
+    }
+}
+
 py::tmpref<py::long_::object> py::long_::object::operator-() const {
+    long long value;
+    if (as_word(ob, value) && value != LLONG_MIN) {
+        return _box(-value);
+    }
     return ob_unary_func<PyNumber_Negative>();
 }
 
 py::tmpref<py::long_::object> py::long_::object::operator+() const {
+    if (ob && PyLong_CheckExact(ob)) {
+        // `+x` is `x` for exact ints
+        Py_INCREF(ob);
+        return ob;
+    }
     return ob_unary_func<PyNumber_Positive>();
 }
 
 py::tmpref<py::long_::object> py::long_::object::abs() const {
+    long long value;
+    if (as_word(ob, value) && value != LLONG_MIN) {
+        return _box(value < 0 ? -value : value);
+    }
     return ob_unary_func<PyNumber_Absolute>();
 }
 
 py::tmpref<py::long_::object> py::long_::object::invert() const {
+    long long value;
+    if (as_word(ob, value)) {
+        return _box(~value);
+    }
     return ob_unary_func<PyNumber_Invert>();
 }
+
+py::tmpref<py::long_::object> py::long_::from_bytes(py::span<const char> data,
+                                                    byteorder order,
+                                                    bool is_signed) {
+    return _from_byte_array(data.data(), data.size(), order, is_signed);
+}
+
+namespace {
+    /**
+       Check that a byte array holds whole integers of `width` bytes.
+
+       @return The number of integers or -1 with a `ValueError` set.
+    */
+    py::ssize_t packed_count(std::size_t size, std::size_t width) {
+        if (!width || size % width) {
+            PyErr_Format(PyExc_ValueError,
+                         "%zu bytes is not a multiple of the width %zu",
+                         size,
+                         width);
+            return -1;
+        }
+        return size / width;
+    }
+}
+
+py::tmpref<py::list::object>
+py::long_::from_bytes_array(py::span<const char> data,
+                            std::size_t width,
+                            byteorder order,
+                            bool is_signed) {
+    py::ssize_t count = packed_count(data.size(), width);
+    if (count < 0) {
+        return nullptr;
+    }
+
+    py::list::object out(count);
+    if (!out.is_nonnull()) {
+        return nullptr;
+    }
+    for (py::ssize_t ix = 0; ix < count; ++ix) {
+        PyObject *item = _from_byte_array(data.data() + ix * width,
+                                          width,
+                                          order,
+                                          is_signed);
+        if (!item) {
+            out.decref();
+            return nullptr;
+        }
+        PyList_SET_ITEM((PyObject*) out, ix, item);
+    }
+    return std::move(out).as_tmpref();
+}
+
+int py::long_::_as_bytes_array(PyObject *seq,
+                               py::span<char> out,
+                               std::size_t width,
+                               byteorder order,
+                               bool is_signed) {
+    py::ssize_t count = packed_count(out.size(), width);
+    if (count < 0) {
+        return -1;
+    }
+    if (count != PySequence_Fast_GET_SIZE(seq)) {
+        PyErr_Format(PyExc_ValueError,
+                     "%zd ints do not fill %zu bytes at width %zu",
+                     PySequence_Fast_GET_SIZE(seq),
+                     out.size(),
+                     width);
+        return -1;
+    }
+
+    PyObject **items = PySequence_Fast_ITEMS(seq);
+    for (py::ssize_t ix = 0; ix < count; ++ix) {
+        if (!PyLong_Check(items[ix])) {
+            PyErr_Format(PyExc_TypeError,
+                         "expected int at index %zd, got %.200s",
+                         ix,
+                         Py_TYPE(items[ix])->tp_name);
+            return -1;
+        }
+        if (_as_byte_array(items[ix],
+                           out.data() + ix * width,
+                           width,
+                           order,
+                           is_signed)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+py::long_::_box_cache_state py::long_::_box_cache = {nullptr, nullptr, 0, 0, 0, 0, 0};
+
+namespace {
+    /**
+       Whether `reset_box_cache` is registered to run at finalization.
+    */
+    bool box_cache_reset_registered = false;
+
+    /**
+       Forget the box cache after the interpreter has been finalized. The
+       objects have already been torn down with the interpreter so they are
+       not decrefed.
+    */
+    void reset_box_cache() {
+        PyMem_RawFree(py::long_::_box_cache.table);
+        py::long_::_box_cache = {nullptr, nullptr, 0, 0, 0, 0, 0};
+        box_cache_reset_registered = false;
+    }
+
+    /**
+       The number of bytes allocated for the `int` object holding `value`.
+    */
+    std::size_t int_size(long long value) {
+        unsigned long long magnitude = value < 0 ?
+            -static_cast<unsigned long long>(value) :
+            static_cast<unsigned long long>(value);
+        std::size_t digits = 1;
+        while (magnitude >>= PyLong_SHIFT) {
+            ++digits;
+        }
+        return PyLong_Type.tp_basicsize + digits * PyLong_Type.tp_itemsize;
+    }
+}
+
+int py::long_::enable_box_cache(long long low, long long high) {
+    PyInterpreterState *interp = PyThreadState_Get()->interp;
+    if (_box_cache.table && _box_cache.owner != interp) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the box cache belongs to another interpreter");
+        return -1;
+    }
+    disable_box_cache();
+
+    if (low > high) {
+        PyErr_Format(PyExc_ValueError,
+                     "empty box cache range [%lld, %lld]",
+                     low,
+                     high);
+        return -1;
+    }
+    if (!box_cache_reset_registered) {
+        // a table which outlives the interpreter would hand out freed
+        // objects, so do not enable the cache unless it can be reset
+        if (Py_AtExit(reset_box_cache)) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "cannot register the box cache reset");
+            return -1;
+        }
+        box_cache_reset_registered = true;
+    }
+
+    unsigned long long size = static_cast<unsigned long long>(high) -
+        static_cast<unsigned long long>(low) + 1;
+    if (!size || size > PY_SSIZE_T_MAX / sizeof(PyObject*)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    PyObject **table = static_cast<PyObject**>(
+        PyMem_RawMalloc(size * sizeof(PyObject*)));
+    if (!table) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    std::size_t bytes = size * sizeof(PyObject*);
+    for (unsigned long long ix = 0; ix < size; ++ix) {
+        long long value = static_cast<long long>(
+            static_cast<unsigned long long>(low) + ix);
+        if (!(table[ix] = PyLong_FromLongLong(value))) {
+            for (unsigned long long jx = 0; jx < ix; ++jx) {
+                Py_DECREF(table[jx]);
+            }
+            PyMem_RawFree(table);
+            return -1;
+        }
+        if (value < -5 || value > 256) {
+            // the small ints are shared whether or not they are cached
+            bytes += int_size(value);
+        }
+    }
+
+    _box_cache = {table, interp, low, size, 0, 0, bytes};
+    return 0;
+}
+
+void py::long_::disable_box_cache() {
+    PyObject **table = _box_cache.table;
+    unsigned long long size = _box_cache.size;
+    if (!table || _box_cache.owner != PyThreadState_Get()->interp) {
+        return;
+    }
+    // disable the cache first so that nothing is boxed from a half released
+    // table while the objects are being deallocated
+    _box_cache = {nullptr, nullptr, 0, 0, 0, 0, 0};
+    for (unsigned long long ix = 0; ix < size; ++ix) {
+        Py_DECREF(table[ix]);
+    }
+    PyMem_RawFree(table);
+}
+
+py::long_::box_cache_info py::long_::box_cache_stats() {
+    if (!_box_cache.table) {
+        return {0, -1, 0, 0, 0};
+    }
+    long long high = static_cast<long long>(
+        static_cast<unsigned long long>(_box_cache.low) +
+        _box_cache.size - 1);
+    return {_box_cache.low,
+            high,
+            _box_cache.hits,
+            _box_cache.misses,
+            _box_cache.bytes};
+}
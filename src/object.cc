@@ -3,6 +3,8 @@
 
 #include "libpy/object.h"
 
+// These are statically allocated by CPython, so they are valid in every
+// interpreter and across reinitialization.
 const py::object py::None = Py_None;
 const py::object py::NotImplemented = Py_NotImplemented;
 const py::object py::Ellipsis = Py_Ellipsis;
@@ -23,49 +25,386 @@ py::object::object(py::tmpref<py::object> &&mvfrom) noexcept : ob(mvfrom.ob) {
     mvfrom.ob = nullptr;
 }
 
-const py::object &py::operator""_p(char c) {
-    static std::unordered_map<char, py::object> cache;
-    py::object &ob = cache[c];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyUnicode_FromStringAndSize(&c, 1);
+py::_literal_node *py::_literal_registry = nullptr;
+
+/**
+   The caches for character literals, these cannot be templates so they
+   are not in `_literal_registry`.
+*/
+static PyObject *char_literals[256];
+static PyObject *wchar_literals[256];
+static std::unordered_map<wchar_t, PyObject*> *wide_wchar_literals = nullptr;
+
+/**
+   Whether `reset_caches` is registered to run at finalization.
+*/
+static bool reset_registered = false;
+
+/**
+   The number of times the interpreter has been finalized. `attr_cache`
+   entries filled in an earlier generation refer to objects which were torn
+   down with that interpreter.
+*/
+static unsigned long interpreter_generation = 0;
+
+PyInterpreterState *py::_literal_owner = nullptr;
+
+/**
+   Visit every literal cache slot.
+*/
+template<typename F>
+static void for_each_literal(F f) {
+    for (py::_literal_node *node = py::_literal_registry;
+         node;
+         node = node->next) {
+        f(*node->slot);
+    }
+    for (PyObject *&ob : char_literals) {
+        f(ob);
+    }
+    for (PyObject *&ob : wchar_literals) {
+        f(ob);
+    }
+    if (wide_wchar_literals) {
+        for (auto &pair : *wide_wchar_literals) {
+            f(pair.second);
+        }
+    }
+}
+
+/**
+   Forget the cached objects after the interpreter has been finalized. The
+   objects have already been torn down with the interpreter so they are not
+   decrefed.
+*/
+static void reset_caches() {
+    for_each_literal([](PyObject *&ob) { ob = nullptr; });
+    reset_registered = false;
+    py::_literal_owner = nullptr;
+    ++interpreter_generation;
+}
+
+/**
+   Make sure `reset_caches` runs when the interpreter is finalized.
+*/
+static void register_reset() {
+    if (!reset_registered) {
+        // if this fails the caches will hold dangling pointers after a
+        // reinitialization, which is the same as not registering at all
+        reset_registered = !Py_AtExit(reset_caches);
+    }
+}
+
+/**
+   Set the error for using the literal caches from an interpreter which does
+   not own them.
+*/
+static void set_foreign_error() {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "the libpy literal caches belong to another "
+                    "interpreter, call py::clear_literals() from that "
+                    "interpreter first");
+}
+
+int py::_literal_claim() {
+    PyInterpreterState *interp = PyThreadState_Get()->interp;
+    if (_literal_owner && _literal_owner != interp) {
+        // handing out another interpreter's objects would be silently
+        // wrong, so refuse until the owner releases the caches
+        set_foreign_error();
+        return -1;
+    }
+    _literal_owner = interp;
+    register_reset();
+    return 0;
+}
+
+PyObject *const &py::_literal_foreign() {
+    static PyObject *const null = nullptr;
+    set_foreign_error();
+    return null;
+}
+
+int py::warm_literals() {
+    // filling skips the slots which are already filled, so make sure that
+    // the caller's interpreter owns them
+    if (_literal_claim()) {
+        return -1;
+    }
+    for (py::_literal_node *node = _literal_registry; node; node = node->next) {
+        if (node->fill()) {
+            return -1;
+        }
     }
-    return ob;
+    return 0;
+}
+
+void py::clear_literals() {
+    for_each_literal([](PyObject *&ob) { Py_CLEAR(ob); });
+    py::_literal_owner = nullptr;
 }
 
-const py::object &py::operator""_p(const char *cs, std::size_t len) {
-    static std::unordered_map<const char*, py::object> cache;
-    py::object &ob = cache[cs];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyUnicode_FromStringAndSize(cs, len);
+/**
+   Read a character literal cache slot, filling it with the interned result
+   of `make` if it is empty.
+*/
+template<typename F>
+static const py::object &char_literal(PyObject *&ob, F make) {
+    if (!ob) {
+        if (!py::_literal_claim() && (ob = make())) {
+            PyUnicode_InternInPlace(&ob);
+        }
+    }
+    else if (PyThreadState_Get()->interp != py::_literal_owner) {
+        return *reinterpret_cast<const py::object*>(&py::_literal_foreign());
     }
-    return ob;
+    return *reinterpret_cast<const py::object*>(&ob);
+}
+
+const py::object &py::operator""_p(char c) {
+    return char_literal(char_literals[(unsigned char) c], [c] {
+        return PyUnicode_FromStringAndSize(&c, 1);
+    });
 }
 
 const py::object &py::operator""_p(wchar_t c) {
-    static std::unordered_map<wchar_t, py::object> cache;
-    py::object &ob = cache[c];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyUnicode_FromWideChar(&c, 1);
+    auto make = [c] { return PyUnicode_FromWideChar(&c, 1); };
+    if (c >= 0 && c < 256) {
+        return char_literal(wchar_literals[c], make);
     }
-    return ob;
+
+    if (!wide_wchar_literals) {
+        wide_wchar_literals = new std::unordered_map<wchar_t, PyObject*>;
+    }
+    return char_literal((*wide_wchar_literals)[c], make);
 }
 
-const py::object &py::operator""_p(const wchar_t *cs, std::size_t len) {
-    static std::unordered_map<const wchar_t*, py::object> cache;
-    py::object &ob = cache[cs];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyUnicode_FromWideChar(cs, len);
+PyObject *py::_stackcall_tuple(PyObject *callable,
+                               PyObject *const *args,
+                               std::size_t nargs,
+                               PyObject *kwnames) {
+    py::tmpref<py::object> pyargs(PyTuple_New(nargs));
+    if (!pyargs.is_nonnull()) {
+        return nullptr;
+    }
+    for (std::size_t n = 0; n < nargs; ++n) {
+        Py_INCREF(args[n]);
+        PyTuple_SET_ITEM((PyObject*) pyargs, n, args[n]);
+    }
+
+    py::tmpref<py::object> pykwargs(kwnames ? PyDict_New() : nullptr);
+    if (kwnames) {
+        if (!pykwargs.is_nonnull()) {
+            return nullptr;
+        }
+        for (py::ssize_t n = 0; n < PyTuple_GET_SIZE(kwnames); ++n) {
+            if (PyDict_SetItem(pykwargs,
+                               PyTuple_GET_ITEM(kwnames, n),
+                               args[nargs + n])) {
+                return nullptr;
+            }
+        }
+    }
+    return PyObject_Call(callable, pyargs, pykwargs);
+}
+
+#if PY_VERSION_HEX < 0x03090000
+/**
+   Check if calling `descr.__get__(self)` would just bind `self` as the first
+   argument, which means we can skip creating the bound method.
+*/
+static bool is_method_descriptor(PyObject *descr) {
+#if HAVE_VECTORCALL
+    return PyType_HasFeature(Py_TYPE(descr), Py_TPFLAGS_METHOD_DESCRIPTOR);
+#else
+    return PyFunction_Check(descr) ||
+        Py_TYPE(descr) == &PyMethodDescr_Type;
+#endif
+}
+
+int py::_getmethod(PyObject *self, PyObject *name, PyObject **method) {
+    PyTypeObject *tp = Py_TYPE(self);
+
+    *method = nullptr;
+    if (tp->tp_getattro == PyObject_GenericGetAttr &&
+        PyUnicode_CheckExact(name)) {
+        if (!tp->tp_dict && PyType_Ready(tp) < 0) {
+            return -1;
+        }
+
+        // _PyType_Lookup returns a borrowed reference
+        PyObject *descr = _PyType_Lookup(tp, name);
+        if (descr && is_method_descriptor(descr)) {
+            PyObject **dictptr = _PyObject_GetDictPtr(self);
+            PyObject *attr = (dictptr && *dictptr) ?
+                PyDict_GetItem(*dictptr, name) :
+                nullptr;
+
+            if (!attr) {
+                Py_INCREF(descr);
+                *method = descr;
+                return 1;
+            }
+            Py_INCREF(attr);
+            *method = attr;
+            return 0;
+        }
+    }
+
+    *method = PyObject_GetAttr(self, name);
+    return *method ? 0 : -1;
+}
+#endif
+
+/**
+   Get the version tag for a type or 0 if the tag is not valid.
+*/
+static unsigned int valid_version_tag(PyTypeObject *tp) {
+#if PY_VERSION_HEX >= 0x030c0000
+    return tp->tp_version_tag;
+#else
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        return 0;
+    }
+    return tp->tp_version_tag;
+#endif
+}
+
+/**
+   Check if objects of type `tp` may have an instance dict.
+
+   From 3.11 ordinary classes have a managed dict: the attributes are stored
+   inline and `tp_dictoffset` is -1. `_PyObject_GetDictPtr` still gives us
+   the dict, it is materialized the first time it is needed for an object
+   just like when Python code reads `__dict__`.
+*/
+static bool has_instance_dict(PyTypeObject *tp) {
+#ifdef Py_TPFLAGS_MANAGED_DICT
+    if (PyType_HasFeature(tp, Py_TPFLAGS_MANAGED_DICT)) {
+        return true;
+    }
+#endif
+    return tp->tp_dictoffset;
+}
+
+py::attr_cache::attr_cache()
+    : type(nullptr),
+      version_tag(0),
+      name(nullptr),
+      descr(nullptr),
+      k(kind::generic),
+      generation(interpreter_generation) {}
+
+py::attr_cache::~attr_cache() {
+    // caches are usually static and may be destroyed after Py_Finalize
+    if (Py_IsInitialized()) {
+        clear();
     }
-    return ob;
 }
 
-const py::object &py::operator""_p(long double d) {
-    static std::unordered_map<long double, py::object> cache;
-    py::object &ob = cache[d];
-    if (!ob.is_nonnull()) {
-        ob.ob = PyFloat_FromDouble(d);
+void py::attr_cache::clear() {
+    if (generation == interpreter_generation) {
+        Py_CLEAR(name);
+        Py_CLEAR(descr);
+    }
+    else {
+        // the entry belongs to an interpreter which has been finalized
+        name = nullptr;
+        descr = nullptr;
+        generation = interpreter_generation;
     }
-    return ob;
+    type = nullptr;
+    version_tag = 0;
+    k = kind::generic;
+}
+
+void py::attr_cache::fill(PyTypeObject *tp, PyObject *attr) {
+    clear();
+
+    if (tp->tp_getattro != PyObject_GenericGetAttr ||
+        !PyUnicode_CheckExact(attr)) {
+        // the entry is not stored so we will try to fill the cache each time
+        return;
+    }
+
+    if (!tp->tp_dict && PyType_Ready(tp) < 0) {
+        PyErr_Clear();
+        return;
+    }
+
+    // _PyType_Lookup returns a borrowed reference and assigns the version tag
+    PyObject *found = _PyType_Lookup(tp, attr);
+    unsigned int tag = valid_version_tag(tp);
+    if (!tag) {
+        return;
+    }
+
+    if (found &&
+        Py_TYPE(found)->tp_descr_get &&
+        Py_TYPE(found)->tp_descr_set) {
+        k = kind::data_descriptor;
+    }
+    else if (found) {
+        k = kind::type_attribute;
+    }
+    else {
+        k = kind::instance_attribute;
+    }
+
+    register_reset();
+    Py_XINCREF(found);
+    descr = found;
+    Py_INCREF(attr);
+    name = attr;
+    type = tp;
+    version_tag = tag;
+}
+
+PyObject *py::attr_cache::getattr(PyObject *ob, PyObject *attr) {
+    PyTypeObject *tp = Py_TYPE(ob);
+
+    if (tp != type ||
+        generation != interpreter_generation ||
+        valid_version_tag(tp) != version_tag ||
+        attr != name) {
+        fill(tp, attr);
+        if (!type) {
+            return PyObject_GetAttr(ob, attr);
+        }
+    }
+
+    if (k == kind::generic) {
+        return PyObject_GetAttr(ob, attr);
+    }
+    if (k == kind::data_descriptor) {
+        return Py_TYPE(descr)->tp_descr_get(descr, ob, (PyObject*) tp);
+    }
+
+    if (has_instance_dict(tp)) {
+        PyObject **dictptr = _PyObject_GetDictPtr(ob);
+        if (dictptr && *dictptr) {
+            PyObject *value = PyDict_GetItemWithError(*dictptr, attr);
+            if (value) {
+                Py_INCREF(value);
+                return value;
+            }
+            if (PyErr_Occurred()) {
+                return nullptr;
+            }
+        }
+    }
+
+    if (k == kind::instance_attribute) {
+        // let Python raise the AttributeError
+        return PyObject_GetAttr(ob, attr);
+    }
+
+    descrgetfunc get = Py_TYPE(descr)->tp_descr_get;
+    if (get) {
+        return get(descr, ob, (PyObject*) tp);
+    }
+    Py_INCREF(descr);
+    return descr;
 }
 
 std::ostream &py::operator<<(std::ostream &stream, const py::object &ob) {
@@ -234,6 +573,15 @@ const py::object &py::object::incref() const {
 
 const py::object &py::object::decref() {
     if (is_nonnull()) {
+#if PY_VERSION_HEX >= 0x03080000
+        // the refcount debugging macros used below are private in 3.8+ so
+        // we defer to Py_DECREF and just check if we hold the last reference
+        PyObject *tmp = ob;
+        if (Py_REFCNT(tmp) == 1) {
+            ob = nullptr;
+        }
+        Py_DECREF(tmp);
+#else
         // reimplement the Py_DECREF macro here so that we can set ob = nullptr
         // when we dealloc without checking the refcount twice
         if (_Py_DEC_REFTOTAL  _Py_REF_DEBUG_COMMA --(ob)->ob_refcnt != 0) {
@@ -242,6 +590,7 @@ const py::object &py::object::decref() {
             _Py_Dealloc(ob);
             ob = nullptr;
         }
+#endif
     }
     return *this;
 }
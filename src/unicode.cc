@@ -0,0 +1,775 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#else
+#define HAVE_X86_SIMD 0
+#endif
+
+#include "libpy/unicode.h"
+#include "libpy/utils.h"
+
+namespace u = py::unicode;
+
+// `PyUnicode_Type` is statically allocated so this is valid in every
+// interpreter
+const py::type::object<u::object> u::type((PyObject*) &PyUnicode_Type);
+
+namespace {
+    /**
+       Ensure the canonical representation of a str exists.
+
+       @param ob The str to ready.
+       @return   true on success, false with a Python exception set.
+    */
+    inline bool ready(PyObject *ob) {
+#if HAVE_UNICODE_READY
+        return PyUnicode_READY(ob) == 0;
+#else
+        (void) ob;
+        return true;
+#endif
+    }
+
+    const char *kind_name(int kind) {
+        switch (kind) {
+        case PyUnicode_1BYTE_KIND:
+            return "PyUnicode_1BYTE_KIND";
+        case PyUnicode_2BYTE_KIND:
+            return "PyUnicode_2BYTE_KIND";
+        default:
+            return "PyUnicode_4BYTE_KIND";
+        }
+    }
+
+    template<typename C>
+    u::basic_string_view<C> view(PyObject *ob) {
+        return u::basic_string_view<C>(
+            reinterpret_cast<const C*>(PyUnicode_DATA(ob)),
+            PyUnicode_GET_LENGTH(ob));
+    }
+
+#if HAVE_X86_SIMD
+    namespace sse2 {
+        using reg = __m128i;
+        constexpr py::ssize_t width = sizeof(reg);
+
+        inline reg splat(char c) {
+            return _mm_set1_epi8(c);
+        }
+
+        inline reg load(const char *p) {
+            return _mm_loadu_si128(reinterpret_cast<const reg*>(p));
+        }
+
+        inline std::uint32_t eq_mask(reg a, reg b) {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+        }
+
+        #include "_unicode_kernels.h"
+    }
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+    namespace avx2 {
+        using reg = __m256i;
+        constexpr py::ssize_t width = sizeof(reg);
+
+        inline reg splat(char c) {
+            return _mm256_set1_epi8(c);
+        }
+
+        inline reg load(const char *p) {
+            return _mm256_loadu_si256(reinterpret_cast<const reg*>(p));
+        }
+
+        inline std::uint32_t eq_mask(reg a, reg b) {
+            return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        }
+
+        #include "_unicode_kernels.h"
+    }
+#pragma GCC pop_options
+#else
+    namespace scalar {
+        const char *find_byte(const char *begin, const char *end, char c) {
+            const void *p = std::memchr(begin, c, end - begin);
+            return p ? static_cast<const char*>(p) : end;
+        }
+
+        py::ssize_t count_byte(const char *begin, const char *end, char c) {
+            py::ssize_t count = 0;
+            for (; begin < end; ++begin) {
+                count += *begin == c;
+            }
+            return count;
+        }
+
+        const char *find(const char *begin,
+                         const char *end,
+                         const char *needle,
+                         py::ssize_t size) {
+            for (const char *p = begin; end - p >= size; ++p) {
+                if (*p == needle[0] && !std::memcmp(p, needle, size)) {
+                    return p;
+                }
+            }
+            return end;
+        }
+    }
+#endif
+
+    /**
+       The byte search kernels for the instruction set of the running CPU.
+    */
+    struct kernels {
+        const char *(*find_byte)(const char*, const char*, char);
+        py::ssize_t (*count_byte)(const char*, const char*, char);
+        const char *(*find)(const char*,
+                            const char*,
+                            const char*,
+                            py::ssize_t);
+
+        static const kernels &get() {
+            static const kernels k = select();
+            return k;
+        }
+
+    private:
+        static kernels select() {
+#if HAVE_X86_SIMD
+            if (__builtin_cpu_supports("avx2")) {
+                return {avx2::find_byte, avx2::count_byte, avx2::find};
+            }
+            return {sse2::find_byte, sse2::count_byte, sse2::find};
+#else
+            return {scalar::find_byte, scalar::count_byte, scalar::find};
+#endif
+        }
+    };
+
+    /**
+       A latin-1 string which can be searched bytewise.
+    */
+    struct bytes_view {
+        const char *begin;
+        const char *end;
+
+        py::ssize_t size() const {
+            return end - begin;
+        }
+    };
+
+    /**
+       View a str as bytes if it is stored with `PyUnicode_1BYTE_KIND`.
+
+       @param ob  The object to view.
+       @param out The view to fill.
+       @return    true if `ob` is a ready 1 byte kind str, otherwise false.
+    */
+    bool one_byte_view(PyObject *ob, bytes_view &out) {
+        if (!(PyUnicode_Check(ob) &&
+              PyUnicode_IS_READY(ob) &&
+              PyUnicode_KIND(ob) == PyUnicode_1BYTE_KIND)) {
+            return false;
+        }
+        out.begin = reinterpret_cast<const char*>(PyUnicode_DATA(ob));
+        out.end = out.begin + PyUnicode_GET_LENGTH(ob);
+        return true;
+    }
+
+    /**
+       Find `needle` in `[begin, haystack.end)`.
+
+       @return A pointer to the first occurrence or `haystack.end`.
+    */
+    inline const char *find_in(const kernels &k,
+                               const char *begin,
+                               const bytes_view &haystack,
+                               const bytes_view &needle) {
+        if (needle.size() == 1) {
+            return k.find_byte(begin, haystack.end, *needle.begin);
+        }
+        return k.find(begin, haystack.end, needle.begin, needle.size());
+    }
+
+    /**
+       Count the non-overlapping occurrences of a non-empty `needle`.
+
+       @param limit Stop counting after this many occurrences, or -1 for no
+                    limit.
+    */
+    py::ssize_t count_in(const kernels &k,
+                         const bytes_view &haystack,
+                         const bytes_view &needle,
+                         py::ssize_t limit = -1) {
+        if (needle.size() == 1 && limit < 0) {
+            return k.count_byte(haystack.begin, haystack.end, *needle.begin);
+        }
+
+        py::ssize_t count = 0;
+        const char *p = haystack.begin;
+        while (count != limit &&
+               (p = find_in(k, p, haystack, needle)) != haystack.end) {
+            ++count;
+            p += needle.size();
+        }
+        return count;
+    }
+
+    /**
+       Copy `[begin, end)` out of a 1 byte kind str.
+
+       @param ob    The str being sliced.
+       @param begin The start of the slice in `ob`'s storage.
+       @param end   The end of the slice in `ob`'s storage.
+       @return      A new reference to the slice.
+    */
+    PyObject *slice(PyObject *ob, const char *begin, const char *end) {
+        if (!PyUnicode_IS_ASCII(ob)) {
+            return PyUnicode_FromKindAndData(PyUnicode_1BYTE_KIND,
+                                             begin,
+                                             end - begin);
+        }
+
+        // ascii pieces do not need to be scanned for their max char
+        PyObject *out = PyUnicode_New(end - begin, 127);
+        if (out) {
+            std::memcpy(PyUnicode_DATA(out), begin, end - begin);
+        }
+        return out;
+    }
+
+    /**
+       Check if an ASCII character is whitespace for `str.split` and
+       `str.strip`.
+    */
+    inline bool is_ascii_space(char c) {
+        return (c == ' ' ||
+                (c >= '\t' && c <= '\r') ||
+                (c >= 0x1c && c <= 0x1f));
+    }
+}
+
+u::object::object() : py::object() {}
+
+u::object::object(PyObject *pob) : py::object(pob) {
+    unicode_check();
+}
+
+u::object::object(const py::object &pob) : py::object(pob) {
+    unicode_check();
+}
+
+u::object::object(const u::object &cpfrom) :
+    py::object((PyObject*) cpfrom) {}
+
+u::object::object(u::object &&mvfrom) noexcept :
+    py::object((PyObject*) mvfrom) {
+    mvfrom.ob = nullptr;
+}
+
+void u::object::unicode_check() {
+    if (ob && !PyUnicode_Check(ob)) {
+        ob = nullptr;
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "cannot make py::unicode::object from non str");
+        }
+    }
+}
+
+bool u::object::check_kind(int expected) const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return false;
+    }
+    if (!ready(ob)) {
+        return false;
+    }
+    if (PyUnicode_KIND(ob) != expected) {
+        PyErr_Format(PyExc_TypeError,
+                     "cannot view a str of kind %s as %s",
+                     kind_name(PyUnicode_KIND(ob)),
+                     kind_name(expected));
+        return false;
+    }
+    return true;
+}
+
+py::ssize_t u::object::len() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!ready(ob)) {
+        return -1;
+    }
+    return PyUnicode_GET_LENGTH(ob);
+}
+
+int u::object::kind() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+    if (!ready(ob)) {
+        return -1;
+    }
+    return PyUnicode_KIND(ob);
+}
+
+u::string_view u::object::as_string_view() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return string_view();
+    }
+
+    py::ssize_t size;
+    const char *data = PyUnicode_AsUTF8AndSize(ob, &size);
+    if (!data) {
+        return string_view();
+    }
+    return string_view(data, size);
+}
+
+u::basic_string_view<Py_UCS1> u::object::as_ucs1() const {
+    if (!check_kind(PyUnicode_1BYTE_KIND)) {
+        return basic_string_view<Py_UCS1>();
+    }
+    return view<Py_UCS1>(ob);
+}
+
+u::basic_string_view<Py_UCS2> u::object::as_ucs2() const {
+    if (!check_kind(PyUnicode_2BYTE_KIND)) {
+        return basic_string_view<Py_UCS2>();
+    }
+    return view<Py_UCS2>(ob);
+}
+
+u::basic_string_view<Py_UCS4> u::object::as_ucs4() const {
+    if (!check_kind(PyUnicode_4BYTE_KIND)) {
+        return basic_string_view<Py_UCS4>();
+    }
+    return view<Py_UCS4>(ob);
+}
+
+Py_UCS4 u::object::read_char(py::ssize_t idx) const {
+    return PyUnicode_READ(PyUnicode_KIND(ob), PyUnicode_DATA(ob), idx);
+}
+
+Py_UCS4 u::object::read_char_checked(py::ssize_t idx) const {
+    py::ssize_t size = len();
+    if (size < 0) {
+        return (Py_UCS4) -1;
+    }
+    if (idx < 0 || idx >= size) {
+        PyErr_SetString(PyExc_IndexError, "string index out of range");
+        return (Py_UCS4) -1;
+    }
+    return read_char(idx);
+}
+
+py::ssize_t u::object::find(const py::object &sub) const {
+    if (!(is_nonnull() && sub.is_nonnull())) {
+        pyutils::failed_null_check();
+        return -2;
+    }
+
+    bytes_view haystack;
+    bytes_view needle;
+    if (!(one_byte_view(ob, haystack) &&
+          one_byte_view((PyObject*) sub, needle))) {
+        return PyUnicode_Find(ob, (PyObject*) sub, 0, PY_SSIZE_T_MAX, 1);
+    }
+
+    if (!needle.size()) {
+        return 0;
+    }
+    const char *p = find_in(kernels::get(), haystack.begin, haystack, needle);
+    return p == haystack.end ? -1 : p - haystack.begin;
+}
+
+py::ssize_t u::object::count(const py::object &sub) const {
+    if (!(is_nonnull() && sub.is_nonnull())) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+
+    bytes_view haystack;
+    bytes_view needle;
+    if (!(one_byte_view(ob, haystack) &&
+          one_byte_view((PyObject*) sub, needle))) {
+        return PyUnicode_Count(ob, (PyObject*) sub, 0, PY_SSIZE_T_MAX);
+    }
+
+    if (!needle.size()) {
+        return haystack.size() + 1;
+    }
+    return count_in(kernels::get(), haystack, needle);
+}
+
+int u::object::startswith(const py::object &prefix) const {
+    if (!(is_nonnull() && prefix.is_nonnull())) {
+        pyutils::failed_null_check();
+        return -1;
+    }
+
+    bytes_view haystack;
+    bytes_view needle;
+    if (!(one_byte_view(ob, haystack) &&
+          one_byte_view((PyObject*) prefix, needle))) {
+        return PyUnicode_Tailmatch(ob,
+                                   (PyObject*) prefix,
+                                   0,
+                                   PY_SSIZE_T_MAX,
+                                   -1);
+    }
+
+    return (needle.size() <= haystack.size() &&
+            !std::memcmp(haystack.begin, needle.begin, needle.size()));
+}
+
+py::tmpref<py::list::object>
+u::object::split(const py::object &sep, py::ssize_t maxsplit) const {
+    if (!(is_nonnull() && sep.is_nonnull())) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+
+    bytes_view haystack;
+    bytes_view needle;
+    if (!(one_byte_view(ob, haystack) &&
+          one_byte_view((PyObject*) sep, needle))) {
+        return PyUnicode_Split(ob, (PyObject*) sep, maxsplit);
+    }
+    if (!needle.size()) {
+        PyErr_SetString(PyExc_ValueError, "empty separator");
+        return nullptr;
+    }
+
+    const kernels &k = kernels::get();
+    py::ssize_t splits = count_in(k, haystack, needle, maxsplit);
+
+    PyObject *out = PyList_New(splits + 1);
+    if (!out) {
+        return nullptr;
+    }
+
+    const char *p = haystack.begin;
+    for (py::ssize_t n = 0; n < splits; ++n) {
+        const char *match = find_in(k, p, haystack, needle);
+        PyObject *piece = slice(ob, p, match);
+        if (!piece) {
+            Py_DECREF(out);
+            return nullptr;
+        }
+        PyList_SET_ITEM(out, n, piece);
+        p = match + needle.size();
+    }
+    PyObject *piece = slice(ob, p, haystack.end);
+    if (!piece) {
+        Py_DECREF(out);
+        return nullptr;
+    }
+    PyList_SET_ITEM(out, splits, piece);
+    return out;
+}
+
+py::tmpref<py::list::object> u::object::split() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (!(PyUnicode_IS_READY(ob) && PyUnicode_IS_ASCII(ob))) {
+        return PyUnicode_Split(ob, nullptr, -1);
+    }
+
+    const char *data = reinterpret_cast<const char*>(PyUnicode_DATA(ob));
+    py::ssize_t size = PyUnicode_GET_LENGTH(ob);
+    PyObject *out = PyList_New(0);
+    if (!out) {
+        return nullptr;
+    }
+
+    py::ssize_t ix = 0;
+    while (true) {
+        while (ix < size && is_ascii_space(data[ix])) {
+            ++ix;
+        }
+        if (ix == size) {
+            break;
+        }
+        py::ssize_t start = ix;
+        while (ix < size && !is_ascii_space(data[ix])) {
+            ++ix;
+        }
+
+        PyObject *piece = PyUnicode_Substring(ob, start, ix);
+        if (!piece) {
+            Py_DECREF(out);
+            return nullptr;
+        }
+        int err = PyList_Append(out, piece);
+        Py_DECREF(piece);
+        if (err) {
+            Py_DECREF(out);
+            return nullptr;
+        }
+    }
+    return out;
+}
+
+py::tmpref<u::object> u::object::strip() const {
+    if (!is_nonnull()) {
+        pyutils::failed_null_check();
+        return nullptr;
+    }
+    if (!(PyUnicode_IS_READY(ob) && PyUnicode_IS_ASCII(ob))) {
+        return PyObject_CallMethod(ob, "strip", nullptr);
+    }
+
+    const char *data = reinterpret_cast<const char*>(PyUnicode_DATA(ob));
+    py::ssize_t start = 0;
+    py::ssize_t stop = PyUnicode_GET_LENGTH(ob);
+    while (start < stop && is_ascii_space(data[start])) {
+        ++start;
+    }
+    while (stop > start && is_ascii_space(data[stop - 1])) {
+        --stop;
+    }
+    // returns `ob` itself when nothing is stripped from an exact str
+    return PyUnicode_Substring(ob, start, stop);
+}
+
+py::nonnull<u::object> u::object::as_nonnull() const {
+    if (!(is_nonnull() && ready(ob))) {
+        throw pyutils::bad_nonnull();
+    }
+    return nonnull<u::object>(ob);
+}
+
+py::tmpref<u::object> u::object::as_tmpref() && {
+    tmpref<u::object> ret(ob);
+    ob = nullptr;
+    return std::move(ret);
+}
+
+namespace {
+    template<typename From, typename To>
+    void widen(const void *from, void *to, py::ssize_t size) {
+        const From *src = static_cast<const From*>(from);
+        To *dst = static_cast<To*>(to);
+        for (py::ssize_t ix = 0; ix < size; ++ix) {
+            dst[ix] = src[ix];
+        }
+    }
+
+    /**
+       Copy characters into the storage of a str of the same or a wider kind.
+
+       @param to        The storage of the str being written.
+       @param to_kind   The kind of `to`.
+       @param from      The characters to copy.
+       @param from_kind The kind of `from`.
+       @param size      The number of characters to copy.
+    */
+    void copy_chars(void *to,
+                    int to_kind,
+                    const void *from,
+                    int from_kind,
+                    py::ssize_t size) {
+        if (to_kind == from_kind) {
+            std::memcpy(to, from, size * to_kind);
+        }
+        else if (from_kind == PyUnicode_1BYTE_KIND) {
+            if (to_kind == PyUnicode_2BYTE_KIND) {
+                widen<Py_UCS1, Py_UCS2>(from, to, size);
+            }
+            else {
+                widen<Py_UCS1, Py_UCS4>(from, to, size);
+            }
+        }
+        else {
+            widen<Py_UCS2, Py_UCS4>(from, to, size);
+        }
+    }
+
+    inline bool is_ascii(const char *cs, std::size_t size) {
+        for (std::size_t ix = 0; ix < size; ++ix) {
+            if (static_cast<unsigned char>(cs[ix]) & 0x80) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+u::builder::builder() : length(0), maxchar(127), failed(false) {}
+
+u::builder::~builder() {
+    for (const piece &p : pieces) {
+        Py_XDECREF(p.ob);
+    }
+}
+
+u::builder &u::builder::reserve(std::size_t size) {
+    pieces.reserve(size);
+    return *this;
+}
+
+u::builder &u::builder::append_ascii(const char *cs, std::size_t size) {
+    if (!size) {
+        return *this;
+    }
+    // merge adjacent ascii runs into a single piece
+    if (!pieces.empty() && !pieces.back().ob) {
+        pieces.back().size += size;
+    }
+    else {
+        pieces.push_back({nullptr, text.size(), (py::ssize_t) size});
+    }
+    text.append(cs, size);
+    length += size;
+    return *this;
+}
+
+u::builder &u::builder::append_owned(PyObject *ob) {
+    if (!ob || !ready(ob)) {
+        Py_XDECREF(ob);
+        failed = true;
+        return *this;
+    }
+    if (!PyUnicode_GET_LENGTH(ob)) {
+        Py_DECREF(ob);
+        return *this;
+    }
+
+    pieces.push_back({ob, 0, PyUnicode_GET_LENGTH(ob)});
+    length += PyUnicode_GET_LENGTH(ob);
+    // the max char of the kind is enough to pick the kind of the result
+    // because strs are always stored in the narrowest kind that fits
+    Py_UCS4 kind_max = PyUnicode_MAX_CHAR_VALUE(ob);
+    if (kind_max > maxchar) {
+        maxchar = kind_max;
+    }
+    return *this;
+}
+
+u::builder &u::builder::append(const py::object &ob) {
+    if (failed) {
+        return *this;
+    }
+    if (!ob.is_nonnull()) {
+        pyutils::failed_null_check();
+        failed = true;
+        return *this;
+    }
+    if (PyUnicode_Check((PyObject*) ob)) {
+        Py_INCREF((PyObject*) ob);
+        return append_owned((PyObject*) ob);
+    }
+    return append_owned(PyObject_Str((PyObject*) ob));
+}
+
+u::builder &u::builder::append(const char *cs, std::size_t size) {
+    if (failed) {
+        return *this;
+    }
+    if (is_ascii(cs, size)) {
+        return append_ascii(cs, size);
+    }
+    return append_owned(PyUnicode_DecodeUTF8(cs, size, nullptr));
+}
+
+u::builder &u::builder::append(const char *cs) {
+    return append(cs, std::strlen(cs));
+}
+
+u::builder &u::builder::append(const std::string &cs) {
+    return append(cs.data(), cs.size());
+}
+
+u::builder &u::builder::append(u::string_view cs) {
+    return append(cs.data(), cs.size());
+}
+
+u::builder &u::builder::append(char c) {
+    return append(&c, 1);
+}
+
+u::builder &u::builder::append(bool b) {
+    return b ? append("True", 4) : append("False", 5);
+}
+
+u::builder &u::builder::append(long long i) {
+    char buf[24];
+    int size = std::snprintf(buf, sizeof(buf), "%lld", i);
+    return append(buf, size);
+}
+
+u::builder &u::builder::append(unsigned long long i) {
+    char buf[24];
+    int size = std::snprintf(buf, sizeof(buf), "%llu", i);
+    return append(buf, size);
+}
+
+u::builder &u::builder::append(double d) {
+    if (failed) {
+        return *this;
+    }
+    char *repr = PyOS_double_to_string(d, 'r', 0, Py_DTSF_ADD_DOT_0, nullptr);
+    if (!repr) {
+        failed = true;
+        return *this;
+    }
+    append(repr, std::strlen(repr));
+    PyMem_Free(repr);
+    return *this;
+}
+
+py::tmpref<u::object> u::builder::build() {
+    PyObject *out = nullptr;
+    if (failed) {}
+    else if (pieces.size() == 1 &&
+             pieces[0].ob &&
+             PyUnicode_CheckExact(pieces[0].ob)) {
+        // a single exact str can be returned as is
+        out = pieces[0].ob;
+        Py_INCREF(out);
+    }
+    else if ((out = PyUnicode_New(length, maxchar))) {
+        int kind = PyUnicode_KIND(out);
+        char *data = static_cast<char*>(PyUnicode_DATA(out));
+        for (const piece &p : pieces) {
+            if (p.ob) {
+                copy_chars(data,
+                           kind,
+                           PyUnicode_DATA(p.ob),
+                           PyUnicode_KIND(p.ob),
+                           p.size);
+            }
+            else {
+                copy_chars(data,
+                           kind,
+                           text.data() + p.offset,
+                           PyUnicode_1BYTE_KIND,
+                           p.size);
+            }
+            data += p.size * kind;
+        }
+    }
+
+    for (const piece &p : pieces) {
+        Py_XDECREF(p.ob);
+    }
+    pieces.clear();
+    text.clear();
+    length = 0;
+    maxchar = 127;
+    failed = false;
+    return out;
+}
@@ -0,0 +1,577 @@
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/automethod.h"
+#include "libpy/libpy.h"
+
+#include "utils.h"
+
+using py::operator""_p;
+
+PyObject *noargs(PyObject*) {
+    return py::long_::object(1);
+}
+
+PyObject *add(PyObject*, int a, long long b) {
+    return py::long_::object(a + b);
+}
+
+PyObject *scale(PyObject*, double a, float b, bool c) {
+    return PyFloat_FromDouble(c ? a * b : a);
+}
+
+PyObject *identity(PyObject*, py::object ob) {
+    return ob.incref();
+}
+
+PyObject *strlen_or_none(PyObject*, const char *cs) {
+    if (!cs) {
+        return py::None.incref();
+    }
+    return py::long_::object(std::strlen(cs));
+}
+
+PyObject *byte(PyObject*, unsigned char b, char c) {
+    return py::long_::object(b + c);
+}
+
+PyObject *buffer_len(PyObject*, Py_buffer buf) {
+    return py::long_::object(buf.len);
+}
+
+std::int64_t return_int(PyObject*, std::int64_t a) {
+    return a * 2;
+}
+
+std::uint16_t return_code(PyObject*, long a) {
+    return static_cast<std::uint16_t>(a);
+}
+
+double return_double(PyObject*, double a) {
+    return a / 2;
+}
+
+bool return_bool(PyObject*, long a) {
+    return a > 0;
+}
+
+std::string return_string(PyObject*, long a) {
+    return std::string(a, 'a');
+}
+
+std::vector<long> return_vector(PyObject*, long a) {
+    std::vector<long> out;
+    for (long n = 0; n < a; ++n) {
+        out.push_back(n);
+    }
+    return out;
+}
+
+std::tuple<long, std::string, std::vector<bool>> return_tuple(PyObject*) {
+    return std::make_tuple(1, "a", std::vector<bool>{true, false});
+}
+
+py::tmpref<py::object> return_tmpref(PyObject*, py::object ob) {
+    return (PyObject*) ob.incref();
+}
+
+void return_void(PyObject*, long) {}
+
+long throws(PyObject*, long kind) {
+    switch (kind) {
+    case 0:
+        PyErr_SetString(PyExc_KeyError, "a");
+        throw py::error_already_set();
+    case 1:
+        return py::object(nullptr).as_nonnull().len();
+    case 2:
+        throw std::bad_alloc();
+    case 3:
+        return std::vector<long>().at(1);
+    case 4:
+        throw std::runtime_error("runtime");
+    default:
+        return kind;
+    }
+}
+
+std::string kernel_int(PyObject*, long) {
+    return "int";
+}
+
+std::string kernel_float(PyObject*, double) {
+    return "float";
+}
+
+std::string kernel_str(PyObject*, const char*) {
+    return "str";
+}
+
+std::string kernel_pair(PyObject*, long, long) {
+    return "pair";
+}
+
+std::string kernel_none(PyObject*) {
+    return "none";
+}
+
+double sum_nogil(Py_buffer buf, double scale) {
+    double out = 0;
+    for (Py_ssize_t n = 0; n < buf.len; ++n) {
+        out += ((unsigned char*) buf.buf)[n];
+    }
+    return out * scale;
+}
+
+bool gil_held() {
+    return PyGILState_Check();
+}
+
+void throws_nogil(long n) {
+    std::vector<long>().at(n);
+}
+
+PyObject *affine(PyObject*, long a, double b, double c) {
+    return PyFloat_FromDouble(a * b + c);
+}
+
+/**
+   Create a Python callable from a `PyMethodDef`.
+
+   `PyCFunction_New` stores a pointer to the def so it must outlive the
+   function.
+*/
+py::object as_function(PyMethodDef &def) {
+    return PyCFunction_New(&def, nullptr);
+}
+
+TEST(Automethod, noargs) {
+    static PyMethodDef def = automethod(noargs);
+    EXPECT_STREQ(def.ml_name, "noargs");
+    EXPECT_EQ(def.ml_flags, METH_NOARGS);
+
+    py::object f = as_function(def);
+    py::object res = f();
+    EXPECT_TRUE((res == 1_p).istrue());
+    res.decref();
+    f.decref();
+}
+
+TEST(Automethod, integers) {
+    static PyMethodDef def = automethod(add, "doc");
+    EXPECT_STREQ(def.ml_name, "add");
+    EXPECT_STREQ(def.ml_doc, "doc");
+
+    py::object f = as_function(def);
+    py::object res = f(1_p, 2_p);
+    EXPECT_TRUE((res == 3_p).istrue());
+    res.decref();
+
+    // int is range checked
+    EXPECT_FALSE(f(1_p << 40_p, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+
+    // floats are not implicitly truncated
+    EXPECT_FALSE(f(1.5_p, 2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(1_p, 2_p, 3_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    f.decref();
+}
+
+TEST(Automethod, floating) {
+    static PyMethodDef def = automethod(scale);
+    py::object f = as_function(def);
+
+    py::tmpref<py::object> res = f(1.5_p, 2_p, py::True);
+    EXPECT_TRUE((res == 3.0_p).istrue());
+
+    res = f(1.5_p, 2_p, 0_p);
+    EXPECT_TRUE((res == 1.5_p).istrue());
+
+    EXPECT_FALSE(f("a"_p, 2_p, py::True).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    f.decref();
+}
+
+TEST(Automethod, objects) {
+    static PyMethodDef def = named_automethod("ident", identity);
+    EXPECT_STREQ(def.ml_name, "ident");
+
+    py::object f = as_function(def);
+    py::object res = f("a"_p);
+    EXPECT_EQ((PyObject*) res, (PyObject*) "a"_p);
+    res.decref();
+    f.decref();
+}
+
+TEST(Automethod, strings) {
+    static PyMethodDef def = named_automethod("len", strlen_or_none, "doc");
+    EXPECT_STREQ(def.ml_doc, "doc");
+
+    py::object f = as_function(def);
+    py::tmpref<py::object> res = f("abc"_p);
+    EXPECT_TRUE((res == 3_p).istrue());
+
+    res = f(py::None);
+    EXPECT_TRUE(res.is(py::None));
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // the function would only see "a"
+    py::object nul = PyUnicode_FromStringAndSize("a\0b", 3);
+    EXPECT_FALSE(f(nul).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    nul.decref();
+
+    f.decref();
+}
+
+TEST(Automethod, bytes) {
+    static PyMethodDef def = automethod(byte);
+    py::object f = as_function(def);
+
+    py::object c = PyBytes_FromString("a");
+    py::object res = f(1_p, c);
+    EXPECT_TRUE((res == py::long_::object(1 + 'a')).istrue());
+    res.decref();
+
+    EXPECT_FALSE(f(256_p, c).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+
+    c.decref();
+    f.decref();
+}
+
+TEST(Automethod, buffer) {
+    static PyMethodDef def = automethod(buffer_len);
+    py::object f = as_function(def);
+
+    py::object bs = PyBytes_FromString("abcd");
+    py::object res = f(bs);
+    EXPECT_TRUE((res == 4_p).istrue());
+    res.decref();
+    EXPECT_EQ(bs.refcnt(), 1);
+    bs.decref();
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    f.decref();
+}
+
+TEST(Automethod, keywords) {
+    using py::operator""_kw;
+
+    static PyMethodDef def = automethod_kw(affine,
+                                           "doc",
+                                           "a"_kw,
+                                           "b"_kw = 2.0,
+                                           "c"_kw = 0.5);
+    EXPECT_STREQ(def.ml_name, "affine");
+    EXPECT_STREQ(def.ml_doc, "doc");
+    EXPECT_TRUE(def.ml_flags & METH_KEYWORDS);
+
+    py::object f = as_function(def);
+    py::object res = f(1_p);
+    EXPECT_TRUE((res == 2.5_p).istrue());
+
+    res = f(1_p, 3_p);
+    EXPECT_TRUE((res == 3.5_p).istrue());
+
+    res = f(2_p, "c"_kw = 1_p);
+    EXPECT_TRUE((res == 5.0_p).istrue());
+
+    res = f("c"_kw = 0_p, "b"_kw = 1_p, "a"_kw = 3_p);
+    EXPECT_TRUE((res == 3.0_p).istrue());
+
+    // keywords which are equal but not interned still match
+    py::object kwargs = PyDict_New();
+    py::object b = PyUnicode_FromStringAndSize("bb", 1);
+    PyDict_SetItem(kwargs, b, 4_p);
+    auto args = py::tuple::pack(1_p);
+    res = f.call(args, kwargs);
+    EXPECT_TRUE((res == 4.5_p).istrue());
+    res.decref();
+    b.decref();
+    kwargs.decref();
+
+    f.decref();
+}
+
+TEST(Automethod, keywords_errors) {
+    using py::operator""_kw;
+
+    static PyMethodDef def = named_automethod_kw("f",
+                                                 affine,
+                                                 nullptr,
+                                                 "a"_kw,
+                                                 "b"_kw = 2.0,
+                                                 "c"_kw = 0.5);
+    EXPECT_STREQ(def.ml_name, "f");
+
+    py::object f = as_function(def);
+
+    // missing required argument
+    EXPECT_FALSE(f().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+    EXPECT_FALSE(f("b"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // unknown keyword
+    EXPECT_FALSE(f(1_p, "d"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // given by name and position
+    EXPECT_FALSE(f(1_p, 2_p, "b"_kw = 1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // too many positional arguments
+    EXPECT_FALSE(f(1_p, 2_p, 3_p, 4_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    // conversion errors are reported for keywords
+    EXPECT_FALSE(f(1_p, "c"_kw = "c"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    f.decref();
+}
+
+TEST(Automethod, boxing) {
+    static PyMethodDef int_def = automethod(return_int);
+    static PyMethodDef double_def = automethod(return_double);
+    static PyMethodDef bool_def = automethod(return_bool);
+    static PyMethodDef string_def = automethod(return_string);
+    static PyMethodDef vector_def = automethod(return_vector);
+    static PyMethodDef tuple_def = automethod(return_tuple);
+    static PyMethodDef tmpref_def = automethod(return_tmpref);
+    static PyMethodDef void_def = automethod(return_void);
+
+    py::object f = as_function(int_def);
+    py::object res = f(21_p);
+    EXPECT_TRUE((res == 42_p).istrue());
+    res = f(1_p << 40_p);
+    EXPECT_TRUE((res == (1_p << 41_p)).istrue());
+
+    f = as_function(double_def);
+    res = f(3_p);
+    EXPECT_TRUE((res == 1.5_p).istrue());
+
+    f = as_function(bool_def);
+    res = f(1_p);
+    EXPECT_TRUE(res.is(py::True));
+    res = f(-1_p);
+    EXPECT_TRUE(res.is(py::False));
+
+    f = as_function(string_def);
+    res = f(3_p);
+    EXPECT_TRUE((res == "aaa"_p).istrue());
+
+    f = as_function(vector_def);
+    res = f(3_p);
+    ASSERT_TRUE(PyList_CheckExact((PyObject*) res));
+    ASSERT_EQ(PyList_GET_SIZE((PyObject*) res), 3);
+    for (Py_ssize_t n = 0; n < 3; ++n) {
+        EXPECT_EQ(PyLong_AsLong(PyList_GET_ITEM((PyObject*) res, n)), n);
+    }
+
+    f = as_function(tuple_def);
+    res = f();
+    ASSERT_TRUE(PyTuple_CheckExact((PyObject*) res));
+    ASSERT_EQ(PyTuple_GET_SIZE((PyObject*) res), 3);
+    py::object first = PyTuple_GET_ITEM((PyObject*) res, 0);
+    EXPECT_TRUE((first == 1_p).istrue());
+    py::object second = PyTuple_GET_ITEM((PyObject*) res, 1);
+    EXPECT_TRUE((second == "a"_p).istrue());
+    py::object bools = PyTuple_GET_ITEM((PyObject*) res, 2);
+    ASSERT_TRUE(PyList_CheckExact((PyObject*) bools));
+    EXPECT_TRUE(PyList_GET_ITEM((PyObject*) bools, 0) == Py_True);
+    EXPECT_TRUE(PyList_GET_ITEM((PyObject*) bools, 1) == Py_False);
+
+    f = as_function(tmpref_def);
+    py::object ob = PyList_New(0);
+    res = f(ob);
+    EXPECT_TRUE(res.is(ob));
+    EXPECT_EQ(ob.refcnt(), 2);
+    ob.decref();
+
+    f = as_function(void_def);
+    res = f(1_p);
+    EXPECT_TRUE(res.is(py::None));
+    res.decref();
+    f.decref();
+}
+
+TEST(Automethod, boxing_cache) {
+    static PyMethodDef int_def = automethod(return_int);
+    static PyMethodDef code_def = automethod(return_code);
+    ASSERT_EQ(py::long_::enable_box_cache(0, 65535), 0);
+
+    PyObject *table_entry;
+    {
+        // integer results are served from the box cache
+        auto cached = py::long_::object(1000).as_tmpref();
+        table_entry = cached;
+        py::object f = as_function(int_def);
+        py::tmpref<py::object> res = f(500_p);
+        EXPECT_EQ((PyObject*) res, (PyObject*) cached);
+
+        f = as_function(code_def);
+        res = f(1000_p);
+        EXPECT_EQ((PyObject*) res, (PyObject*) cached);
+        EXPECT_EQ(py::long_::box_cache_stats().hits, 3u);
+        f.decref();
+    }
+    // only the cache itself still holds the object
+    EXPECT_EQ(Py_REFCNT(table_entry), 1);
+    py::long_::disable_box_cache();
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Automethod, exceptions) {
+    static PyMethodDef def = automethod_except(throws);
+    EXPECT_STREQ(def.ml_name, "throws");
+
+    py::object f = as_function(def);
+
+    EXPECT_FALSE(f(0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_KeyError);
+
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    EXPECT_FALSE(f(2_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_MemoryError);
+
+    EXPECT_FALSE(f(3_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_IndexError);
+
+    EXPECT_FALSE(f(4_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+
+    py::object res = f(5_p);
+    EXPECT_TRUE((res == 5_p).istrue());
+    res.decref();
+
+    f.decref();
+}
+
+TEST(Automethod, exceptions_keywords) {
+    using py::operator""_kw;
+
+    static PyMethodDef def = named_automethod_kw_except("f",
+                                                        throws,
+                                                        nullptr,
+                                                        "kind"_kw = 5);
+    py::object f = as_function(def);
+
+    EXPECT_FALSE(f("kind"_kw = 3_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_IndexError);
+
+    py::object res = f();
+    EXPECT_TRUE((res == 5_p).istrue());
+    res.decref();
+
+    f.decref();
+}
+
+TEST(Automethod, overloads) {
+    static PyMethodDef def = automethod_overloads("kernel",
+                                                  "doc",
+                                                  kernel_float,
+                                                  kernel_int,
+                                                  kernel_str,
+                                                  kernel_pair,
+                                                  kernel_none);
+    EXPECT_STREQ(def.ml_name, "kernel");
+    EXPECT_STREQ(def.ml_doc, "doc");
+
+    py::object f = as_function(def);
+
+    // exact matches are preferred over registration order
+    py::object res = f(1_p);
+    EXPECT_TRUE((res == "int"_p).istrue());
+    res = f(1.5_p);
+    EXPECT_TRUE((res == "float"_p).istrue());
+    res = f("a"_p);
+    EXPECT_TRUE((res == "str"_p).istrue());
+    res = f(1_p, 2_p);
+    EXPECT_TRUE((res == "pair"_p).istrue());
+    res = f();
+    EXPECT_TRUE((res == "none"_p).istrue());
+
+    // subclasses fall back to the first loose match
+    res = f(py::True);
+    EXPECT_TRUE((res == "int"_p).istrue());
+    res.decref();
+
+    EXPECT_FALSE(f(py::list::type).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_FALSE(f(1_p, 2_p, 3_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    f.decref();
+}
+
+// Python objects are rejected when they are nested in containers too
+static_assert(!pyutils::_is_python_object<std::vector<double>>::value, "");
+static_assert(!pyutils::_is_python_object<std::tuple<int, bool>>::value, "");
+static_assert(pyutils::_is_python_object<std::vector<py::object>>::value, "");
+static_assert(pyutils::_is_python_object<const std::tuple<PyObject*>&>::value,
+              "");
+static_assert(
+    pyutils::_is_python_object<std::pair<int, std::vector<PyObject*>>>::value,
+    "");
+
+TEST(Automethod, nogil) {
+    static PyMethodDef sum_def = automethod_nogil(sum_nogil, "doc");
+    static PyMethodDef gil_def = named_automethod_nogil("gil", gil_held);
+    static PyMethodDef throws_def = automethod_nogil(throws_nogil);
+    EXPECT_STREQ(sum_def.ml_name, "sum_nogil");
+    EXPECT_STREQ(sum_def.ml_doc, "doc");
+    EXPECT_STREQ(gil_def.ml_name, "gil");
+
+    py::object f = as_function(sum_def);
+    py::object bs = PyBytes_FromStringAndSize("\x01\x02\x03", 3);
+    py::object res = f(bs, 0.5_p);
+    EXPECT_TRUE((res == 3.0_p).istrue());
+    res.decref();
+    EXPECT_EQ(bs.refcnt(), 1);
+    bs.decref();
+
+    EXPECT_FALSE(f(1_p, 0.5_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+    f.decref();
+
+    // PyGILState_Check always returns 1 before threads are initialized on
+    // older versions of Python
+#if PY_VERSION_HEX >= 0x03070000
+    f = as_function(gil_def);
+    res = f();
+    EXPECT_TRUE(res.is(py::False));
+    res.decref();
+    f.decref();
+#endif
+
+    f = as_function(throws_def);
+    EXPECT_FALSE(f(1_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_IndexError);
+    EXPECT_TRUE(PyGILState_Check());
+    f.decref();
+}
@@ -0,0 +1,37 @@
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/libpy.h"
+
+#include "utils.h"
+
+TEST(ByteArray, type) {
+    ASSERT_EQ((PyObject*) py::bytearray::type,
+              (PyObject*) &PyByteArray_Type);
+    auto t = py::bytearray::type();
+
+    EXPECT_EQ((PyObject*) t.type(), (PyObject*) &PyByteArray_Type);
+}
+
+TEST(ByteArray, as_span) {
+    std::string data = "abc";
+    auto ob = py::bytearray::object(
+        py::span<const char>(data.data(), data.size())).as_tmpref();
+    ASSERT_TRUE(ob.is_nonnull());
+    ASSERT_EQ(ob.len(), 3);
+
+    auto view = ob.as_span();
+    EXPECT_EQ(view.data(), PyByteArray_AS_STRING((PyObject*) ob));
+    view[1] = 'x';
+    EXPECT_EQ(PyByteArray_AS_STRING((PyObject*) ob)[1], 'x');
+
+    ASSERT_EQ(ob.resize(5), 0);
+    EXPECT_EQ(ob.len(), 5);
+    EXPECT_EQ(ob.as_nonnull().as_span().size(), 5ul);
+
+    py::bytearray::object null;
+    EXPECT_EQ(null.as_span().data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
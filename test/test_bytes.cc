@@ -0,0 +1,95 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/libpy.h"
+
+#include "utils.h"
+
+TEST(Bytes, type) {
+    ASSERT_EQ((PyObject*) py::bytes::type, (PyObject*) &PyBytes_Type);
+    auto t = py::bytes::type();
+
+    EXPECT_EQ((PyObject*) t.type(), (PyObject*) &PyBytes_Type);
+}
+
+TEST(Bytes, as_span) {
+    std::vector<char> data = {'a', '\0', 'b'};
+    auto ob = py::bytes::object(data).as_tmpref();
+    ASSERT_TRUE(ob.is_nonnull());
+    ASSERT_EQ(ob.len(), 3);
+
+    auto view = ob.as_span();
+    EXPECT_EQ(view.data(), PyBytes_AS_STRING((PyObject*) ob));
+    EXPECT_EQ(std::string(view.begin(), view.end()), std::string("a\0b", 3));
+    EXPECT_EQ(view.subspan(1).size(), 2ul);
+
+    auto nn = ob.as_nonnull();
+    EXPECT_EQ(nn.as_span().data(), view.data());
+
+    py::bytes::object null;
+    EXPECT_EQ(null.as_span().data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    py::bytes::object not_bytes(py::object(PyUnicode_FromString("a"))
+                                .as_tmpref());
+    EXPECT_FALSE(not_bytes.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Bytes, writer) {
+    py::bytes::writer w(4);
+    EXPECT_EQ(w.capacity(), 4);
+
+    std::string expected;
+    for (int n = 0; n < 100; ++n) {
+        std::string piece = std::to_string(n) + ",";
+        w.write(piece.data(), piece.size());
+        expected += piece;
+    }
+    w.write('!');
+    expected += '!';
+
+    char *space = w.reserve(3);
+    ASSERT_NE(space, nullptr);
+    space[0] = 'x';
+    space[1] = 'y';
+    w.commit(2);
+    expected += "xy";
+
+    EXPECT_EQ(w.len(), static_cast<py::ssize_t>(expected.size()));
+    EXPECT_GE(w.capacity(), w.len());
+
+    auto ob = w.finish();
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_EQ(Py_REFCNT((PyObject*) ob), 1);
+    auto view = ob.as_span();
+    EXPECT_EQ(std::string(view.begin(), view.end()), expected);
+
+    // the writer can be reused after finishing
+    EXPECT_EQ(w.len(), 0);
+    auto again = w.write("abc", 3).finish();
+    ASSERT_TRUE(again.is_nonnull());
+    EXPECT_EQ(again.len(), 3);
+
+    auto empty = w.finish();
+    ASSERT_TRUE(empty.is_nonnull());
+    EXPECT_EQ(empty.len(), 0);
+}
+
+TEST(Bytes, writer_errors) {
+    py::bytes::writer w;
+    w.write("abc", 3);
+    EXPECT_EQ(w.reserve(PY_SSIZE_T_MAX), nullptr);
+
+    // writes after a failure are dropped and the first error is kept
+    w.write("def", 3);
+    auto ob = w.finish();
+    EXPECT_FALSE(ob.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_MemoryError);
+
+    // finishing resets the failure
+    EXPECT_TRUE(w.write("def", 3).finish().is_nonnull());
+}
@@ -0,0 +1,141 @@
+#include <climits>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+using py::expr::lazy;
+
+TEST(Expr, lazy) {
+    auto a = 7_p;
+    auto b = py::long_::object(-3).as_tmpref();
+    auto c = 2.5_p;
+
+    auto e = lazy(a) + lazy(b) * 2;
+    static_assert(!std::is_base_of<py::object, decltype(e)>::value,
+                  "lazy expressions are not evaluated until converted");
+
+    expect_same(e.eval(), eval("7 + -3 * 2"));
+    expect_same(lazy(a) + lazy(b) * c - 1, eval("7 + -3 * 2.5 - 1"));
+    expect_same(lazy(a) / b, eval("7 / -3"));
+    expect_same(2 * lazy(a) - lazy(b) / 4.0, eval("2 * 7 - -3 / 4.0"));
+    expect_same(lazy(a) * lazy(a) * lazy(a), eval("7 * 7 * 7"));
+
+    // results in the small int range are the shared objects
+    py::tmpref<py::object> ten = lazy(a) - b;
+    EXPECT_EQ((PyObject*) ten, (PyObject*) 10_p);
+}
+
+TEST(Expr, overflow) {
+    // intermediate results which leave the machine word use bignums
+    auto big = py::long_::object(LLONG_MAX).as_tmpref();
+    expect_same(lazy(big) * big - big,
+                eval("(2 ** 63 - 1) ** 2 - (2 ** 63 - 1)"));
+    expect_same(lazy(big) + 1 - 1, eval("2 ** 63 - 1"));
+
+    auto bignum = eval("2 ** 100");
+    expect_same(lazy(bignum) * 3 + 1.5, eval("2 ** 100 * 3 + 1.5"));
+
+    // int division is only native when both sides are exact doubles
+    auto odd = eval("2 ** 60 + 1");
+    expect_same(lazy(odd) / 3, eval("(2 ** 60 + 1) / 3"));
+}
+
+TEST(Expr, errors) {
+    auto a = 1_p;
+
+    EXPECT_FALSE((lazy(a) / 0).eval().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    EXPECT_FALSE((lazy(a) + 1.0 / lazy(0.0_p)).eval().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    auto text = "a"_p;
+    EXPECT_FALSE((lazy(a) + text).eval().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    py::object null;
+    EXPECT_FALSE((lazy(a) + null).eval().is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST(Expr, generic) {
+    // non numeric operands use the number protocol, including the
+    // reflected methods of the right operand
+    auto a = "a"_p;
+    expect_same(lazy(a) * 3 + "b"_p, eval("'a' * 3 + 'b'"));
+
+    auto R = eval("type('R', (), {'__radd__': lambda self, other: 'radd',"
+                  " '__rmul__': lambda self, other: other * 2})");
+    ASSERT_TRUE(R.is_nonnull());
+    auto r = R();
+    ASSERT_TRUE(r.is_nonnull());
+    expect_same(lazy(1_p) + r, eval("'radd'"));
+    expect_same(lazy(2.5_p) * r + 1, eval("6.0"));
+
+    // int subclasses are not unboxed
+    auto I = eval("type('I', (int,), {'__add__': lambda self, other: 42})");
+    ASSERT_TRUE(I.is_nonnull());
+    auto i = I(1_p);
+    ASSERT_TRUE(i.is_nonnull());
+    expect_same(lazy(i) + 1, eval("42"));
+}
+
+TEST(Expr, inplace) {
+    auto a = 1.5_p;
+    auto b = py::long_::object(1000).as_tmpref();
+
+    // a unique temporary float is reused for the result
+    py::tmpref<py::object> f = a * 2.0_p;
+    PyObject *storage = f;
+    py::tmpref<py::object> g = std::move(f) + 1.0_p;
+    EXPECT_EQ((PyObject*) g, storage);
+    EXPECT_FALSE(f.is_nonnull());
+    expect_same(g, eval("1.5 * 2.0 + 1.0"));
+
+    // and so is a unique temporary int with room for the result
+    py::tmpref<py::object> i = b + 1_p;
+    storage = i;
+    py::tmpref<py::object> j = std::move(i) * 3_p;
+    EXPECT_EQ((PyObject*) j, storage);
+    expect_same(j, eval("(1000 + 1) * 3"));
+
+    // the chained intermediates in an expression are temporaries
+    expect_same(b + 1_p + 2.5_p, eval("1000 + 1 + 2.5"));
+    expect_same(a + 1_p - 0.5 / 2.0_p, eval("1.5 + 1 - 0.5 / 2.0"));
+    expect_same(b - 1_p - 2 * 2_p, eval("1000 - 1 - 2 * 2"));
+}
+
+TEST(Expr, inplace_fallback) {
+    auto a = 1.5_p;
+    auto b = py::long_::object(1000).as_tmpref();
+
+    // a shared object is never written
+    py::tmpref<py::object> shared = a + 1.0_p;
+    py::tmpref<py::object> copy = shared;
+    py::tmpref<py::object> f = std::move(copy) + 1.0_p;
+    EXPECT_NE((PyObject*) f, (PyObject*) shared);
+    expect_same(shared, eval("2.5"));
+    expect_same(f, eval("3.5"));
+
+    // small int results are the shared objects
+    py::tmpref<py::object> i = b + 1_p;
+    py::tmpref<py::object> small = std::move(i) - 1000_p;
+    EXPECT_EQ((PyObject*) small, (PyObject*) 1_p);
+
+    // results which change type or outgrow the storage allocate
+    expect_same(b + 1_p + (1LL << 40), eval("1000 + 1 + 2 ** 40"));
+    expect_same(b * 1_p / 8_p, eval("1000 * 1 / 8"));
+    expect_same(b * 1_p * b * b * b * b * b * b,
+                eval("1000 * 1 * 1000 ** 6"));
+
+    // errors are the same as the eager operators
+    EXPECT_FALSE((a + 1.0_p / 0.0_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+    EXPECT_FALSE((b + 1_p + py::object(nullptr)).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
@@ -0,0 +1,172 @@
+#include <clocale>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/libpy.h"
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Float, type) {
+    ASSERT_EQ((PyObject*) py::float_::type, (PyObject*) &PyFloat_Type);
+    auto t = py::float_::type();
+
+    EXPECT_EQ((PyObject*) t.type(), (PyObject*) &PyFloat_Type);
+}
+
+TEST(Float, from_double) {
+    auto f = py::float_::object(1.5).as_tmpref();
+    ASSERT_TRUE(f.is_nonnull());
+    EXPECT_EQ(f.as_double(), 1.5);
+    EXPECT_EQ(f.as_nonnull().as_double(), 1.5);
+    EXPECT_EQ(py::float_::checkexact(f), 1);
+
+    py::float_::object null;
+    EXPECT_EQ(null.as_double(), -1.0);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    py::float_::object not_float(py::object(PyLong_FromLong(1)).as_tmpref());
+    EXPECT_FALSE(not_float.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Float, literal) {
+    static_assert(std::is_same<decltype(2.5_p),
+                               const py::float_::object&>::value,
+                  "float literals should be float_::object");
+    EXPECT_EQ(2.5_p .as_double(), 2.5);
+}
+
+TEST(Float, literal_forms) {
+    EXPECT_EQ(1'000.5_p .as_double(), 1000.5);
+    EXPECT_EQ(15e-1_p .as_double(), 1.5);
+    EXPECT_EQ(0x1.8p1_p .as_double(), 3.0);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Float, literal_locale) {
+    const char *previous = std::setlocale(LC_NUMERIC, nullptr);
+    std::string restore = previous ? previous : "C";
+
+    bool found = false;
+    for (const char *name : {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8",
+                             "fr_FR.utf8", "de_DE", "fr_FR"}) {
+        if (std::setlocale(LC_NUMERIC, name)) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        GTEST_SKIP() << "no locale with a comma decimal point is installed";
+    }
+
+    // the decimal point of a literal does not depend on the locale
+    double value = 12.75_p .as_double();
+    double hex_value = 0x3.3p0_p .as_double();
+    std::setlocale(LC_NUMERIC, restore.c_str());
+    EXPECT_EQ(value, 12.75);
+    EXPECT_EQ(hex_value, 3.1875);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Float, binary_operators) {
+    auto a = py::float_::object(7.5).as_tmpref();
+    auto b = py::float_::object(-2.0).as_tmpref();
+    auto i = py::object(PyLong_FromLong(3)).as_tmpref();
+
+    expect_same(a + b, PyNumber_Add(a, b));
+    expect_same(a - b, PyNumber_Subtract(a, b));
+    expect_same(a * b, PyNumber_Multiply(a, b));
+    expect_same(a / b, PyNumber_TrueDivide(a, b));
+
+    expect_same(a + i, PyNumber_Add(a, i));
+    expect_same(a - i, PyNumber_Subtract(a, i));
+    expect_same(a * i, PyNumber_Multiply(a, i));
+    expect_same(a / i, PyNumber_TrueDivide(a, i));
+
+    static_assert(std::is_same<decltype(a + b),
+                               py::tmpref<py::float_::object>>::value,
+                  "float + float should be a float");
+    static_assert(std::is_same<decltype(a + i),
+                               py::tmpref<py::object>>::value,
+                  "float + object should be an object");
+}
+
+TEST(Float, double_operators) {
+    auto a = py::float_::object(7.5).as_tmpref();
+    auto b = py::float_::object(-2.0).as_tmpref();
+
+    expect_same(a + -2.0, PyNumber_Add(a, b));
+    expect_same(a - -2.0, PyNumber_Subtract(a, b));
+    expect_same(a * -2.0, PyNumber_Multiply(a, b));
+    expect_same(a / -2.0, PyNumber_TrueDivide(a, b));
+
+    expect_same(-2.0 + a, PyNumber_Add(b, a));
+    expect_same(-2.0 - a, PyNumber_Subtract(b, a));
+    expect_same(-2.0 * a, PyNumber_Multiply(b, a));
+    expect_same(-2.0 / a, PyNumber_TrueDivide(b, a));
+}
+
+TEST(Float, unary_operators) {
+    auto a = py::float_::object(-7.5).as_tmpref();
+
+    EXPECT_EQ((-a).as_double(), 7.5);
+    EXPECT_EQ((+a).as_double(), -7.5);
+    EXPECT_EQ(a.abs().as_double(), 7.5);
+}
+
+TEST(Float, zero_division) {
+    auto a = py::float_::object(1.0).as_tmpref();
+    auto zero = py::float_::object(0.0).as_tmpref();
+
+    EXPECT_FALSE((a / zero).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    EXPECT_FALSE((a / 0.0).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    EXPECT_FALSE((1.0 / zero).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ZeroDivisionError);
+
+    // not an error for floats
+    EXPECT_TRUE(std::isinf((a * 1e308 * 1e308).as_double()));
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Float, int_overflow) {
+    auto a = py::float_::object(1.0).as_tmpref();
+    auto one = py::object(PyLong_FromLong(1)).as_tmpref();
+    auto shift = py::object(PyLong_FromLong(2000)).as_tmpref();
+    auto big = py::object(PyNumber_Lshift(one, shift)).as_tmpref();
+    ASSERT_TRUE(big.is_nonnull());
+
+    EXPECT_FALSE((a + big).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+
+TEST(Float, subclass) {
+    // subclasses go through the number protocol so their overrides are used
+    PyObject *ns = PyEval_GetBuiltins();
+    auto F = py::object(PyRun_String(
+        "type('F', (float,), {'__add__': lambda self, other: 42.0,"
+        " '__radd__': lambda self, other: 43.0})",
+        Py_eval_input,
+        ns,
+        ns)).as_tmpref();
+    ASSERT_TRUE(F.is_nonnull());
+
+    auto instance = F(1.0_p);
+    py::float_::object f(instance);
+    ASSERT_TRUE(f.is_nonnull());
+    auto a = py::float_::object(2.0).as_tmpref();
+
+    EXPECT_EQ((f + a).as_double(), 42.0);
+    EXPECT_EQ((a + f).as_double(), 43.0);
+    EXPECT_EQ((f + 2.0).as_double(), 42.0);
+    EXPECT_EQ((2.0 + f).as_double(), 43.0);
+    EXPECT_NO_PYTHON_ERR();
+}
@@ -1,6 +1,10 @@
+#include <climits>
+#include <cstdint>
 #include <limits>
+#include <string>
 #include <type_traits>
 #include <typeinfo>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -127,3 +131,449 @@ TEST(Long, check) {
     EXPECT_TRUE(py::long_::check(m.as_nonnull()));
     EXPECT_TRUE(py::long_::checkexact(m.as_nonnull()));
 }
+
+namespace {
+/**
+   Build the operands for the arithmetic tests: values around the small int
+   cache, the digit boundaries, the machine word boundaries, and bignums.
+*/
+std::vector<py::tmpref<py::object>> arithmetic_operands() {
+    std::vector<py::tmpref<py::object>> out;
+    for (long long n : {0LL,
+                        1LL,
+                        -1LL,
+                        5LL,
+                        -5LL,
+                        63LL,
+                        64LL,
+                        256LL,
+                        257LL,
+                        1LL << 30,
+                        -(1LL << 30),
+                        (1LL << 31) + 7,
+                        1LL << 60,
+                        -(1LL << 60) - 3,
+                        LLONG_MAX,
+                        LLONG_MIN}) {
+        out.emplace_back(PyLong_FromLongLong(n));
+    }
+    out.emplace_back(PyLong_FromUnsignedLongLong(ULLONG_MAX));
+    out.emplace_back(PyNumber_Multiply(out.back(), out.back()));
+    out.emplace_back(PyNumber_Negative(out.back()));
+    return out;
+}
+
+/**
+   Check that `f()` matches `expected`, which was computed through the
+   number protocol, including raising the same exception.
+*/
+template<typename F>
+void expect_protocol(PyObject *expected, F f) {
+    PyObject *type;
+    PyObject *value;
+    PyObject *tb;
+    PyErr_Fetch(&type, &value, &tb);
+
+    auto result = f();
+    if (!expected) {
+        EXPECT_FALSE(result.is_nonnull());
+        EXPECT_TRUE(PyErr_ExceptionMatches(type));
+        PyErr_Clear();
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(tb);
+        return;
+    }
+    expect_same(result, expected);
+}
+}  // namespace
+
+TEST(Long, binary_operators) {
+    auto operands = arithmetic_operands();
+    for (const auto &a_ob : operands) {
+        for (const auto &b_ob : operands) {
+            py::long_::object a(a_ob);
+            py::long_::object b(b_ob);
+
+            expect_protocol(PyNumber_Add(a, b), [&] { return a + b; });
+            expect_protocol(PyNumber_Subtract(a, b), [&] { return a - b; });
+            expect_protocol(PyNumber_Multiply(a, b), [&] { return a * b; });
+            expect_protocol(PyNumber_Remainder(a, b), [&] { return a % b; });
+            expect_protocol(PyNumber_And(a, b), [&] { return a & b; });
+            expect_protocol(PyNumber_Xor(a, b), [&] { return a ^ b; });
+            expect_protocol(PyNumber_Or(a, b), [&] { return a | b; });
+            expect_protocol(PyNumber_Rshift(a, b), [&] { return a >> b; });
+
+            // keep the left shifts small enough to compute
+            if (PyLong_AsDouble(b) < 200) {
+                expect_protocol(PyNumber_Lshift(a, b), [&] { return a << b; });
+            }
+        }
+    }
+}
+
+TEST(Long, unary_operators) {
+    for (const auto &a_ob : arithmetic_operands()) {
+        py::long_::object a(a_ob);
+
+        expect_protocol(PyNumber_Negative(a), [&] { return -a; });
+        expect_protocol(PyNumber_Positive(a), [&] { return +a; });
+        expect_protocol(PyNumber_Absolute(a), [&] { return a.abs(); });
+        expect_protocol(PyNumber_Invert(a), [&] { return a.invert(); });
+    }
+}
+
+template<typename I>
+void check_integer_operators(const py::long_::object &a, I i) {
+    auto boxed = py::long_::object(i).as_tmpref();
+    ASSERT_TRUE(boxed.is_nonnull());
+
+    expect_protocol(PyNumber_Add(a, boxed), [&] { return a + i; });
+    expect_protocol(PyNumber_Subtract(a, boxed), [&] { return a - i; });
+    expect_protocol(PyNumber_Multiply(a, boxed), [&] { return a * i; });
+    expect_protocol(PyNumber_Remainder(a, boxed), [&] { return a % i; });
+    expect_protocol(PyNumber_And(a, boxed), [&] { return a & i; });
+    expect_protocol(PyNumber_Xor(a, boxed), [&] { return a ^ i; });
+    expect_protocol(PyNumber_Or(a, boxed), [&] { return a | i; });
+    expect_protocol(PyNumber_Rshift(a, boxed), [&] { return a >> i; });
+
+    expect_protocol(PyNumber_Add(boxed, a), [&] { return i + a; });
+    expect_protocol(PyNumber_Subtract(boxed, a), [&] { return i - a; });
+    expect_protocol(PyNumber_Multiply(boxed, a), [&] { return i * a; });
+    expect_protocol(PyNumber_Remainder(boxed, a), [&] { return i % a; });
+    expect_protocol(PyNumber_And(boxed, a), [&] { return i & a; });
+    expect_protocol(PyNumber_Xor(boxed, a), [&] { return i ^ a; });
+    expect_protocol(PyNumber_Or(boxed, a), [&] { return i | a; });
+    expect_protocol(PyNumber_Rshift(boxed, a), [&] { return i >> a; });
+
+    // keep the left shifts small enough to compute
+    if (PyLong_AsDouble(boxed) < 200) {
+        expect_protocol(PyNumber_Lshift(a, boxed), [&] { return a << i; });
+    }
+    if (PyLong_AsDouble(a) < 200) {
+        expect_protocol(PyNumber_Lshift(boxed, a), [&] { return i << a; });
+    }
+}
+
+TEST(Long, integer_operators) {
+    for (const auto &a_ob : arithmetic_operands()) {
+        py::long_::object a(a_ob);
+
+        for (long long i : {0LL, 1LL, -1LL, 7LL, -3LL, 64LL, LLONG_MAX,
+                            LLONG_MIN}) {
+            check_integer_operators(a, i);
+        }
+        check_integer_operators(a, 5);
+        check_integer_operators(a, static_cast<short>(-2));
+        check_integer_operators(a, 5u);
+        check_integer_operators(a, ULLONG_MAX);
+    }
+
+    static_assert(std::is_same<decltype(1_p + 1),
+                               py::tmpref<py::long_::object>>::value,
+                  "long + int should be a long");
+    static_assert(std::is_same<decltype(1 << 1_p),
+                               py::tmpref<py::long_::object>>::value,
+                  "int << long should be a long");
+}
+
+TEST(Long, small_int_results) {
+    // results in the interpreter's small int range are the shared objects
+    auto a = py::long_::object(200).as_tmpref();
+    auto b = py::long_::object(-190).as_tmpref();
+
+    EXPECT_EQ((PyObject*) (a + b), (PyObject*) 10_p);
+    EXPECT_EQ((PyObject*) (a & 15_p), (PyObject*) 8_p);
+}
+
+TEST(Long, to_vector) {
+    std::vector<long long> values = {0, -5, 1 << 20, 300, LLONG_MIN};
+    auto list = py::long_::from_span(py::span<const long long>(values));
+    ASSERT_TRUE(list.is_nonnull());
+    auto tuple = py::long_::from_span<py::tuple::object>(
+        py::span<const long long>(values));
+    ASSERT_TRUE(tuple.is_nonnull());
+
+    EXPECT_EQ(py::long_::to_vector<long long>(list), values);
+    EXPECT_EQ(py::long_::to_vector<long long>(tuple), values);
+    EXPECT_NO_PYTHON_ERR();
+
+    std::vector<short> small = {1, -2, 3};
+    auto small_list = py::long_::from_span(py::span<const short>(small));
+    EXPECT_EQ(py::long_::to_vector<short>(small_list), small);
+    EXPECT_NO_PYTHON_ERR();
+
+    // int subclasses are still ints
+    py::list::object with_bool(1);
+    Py_INCREF(Py_True);
+    PyList_SET_ITEM((PyObject*) with_bool, 0, Py_True);
+    EXPECT_EQ(py::long_::to_vector<int>(with_bool), std::vector<int>{1});
+    EXPECT_NO_PYTHON_ERR();
+    with_bool.decref();
+}
+
+TEST(Long, to_vector_errors) {
+    std::vector<long long> values = {1, 256, 2};
+    auto list = py::long_::from_span(py::span<const long long>(values));
+    ASSERT_TRUE(list.is_nonnull());
+
+    EXPECT_TRUE(py::long_::to_vector<std::uint8_t>(list).empty());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+
+    EXPECT_TRUE(py::long_::to_vector<unsigned int>(
+                    py::long_::from_span(
+                        py::span<const int>(std::vector<int>{-1})))
+                .empty());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+
+    auto bignum = py::long_::object(ULLONG_MAX).as_tmpref() + 1_p;
+    py::list::object big_list(1);
+    Py_INCREF((PyObject*) bignum);
+    PyList_SET_ITEM((PyObject*) big_list, 0, (PyObject*) bignum);
+    EXPECT_TRUE(py::long_::to_vector<long long>(big_list).empty());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+    EXPECT_TRUE(py::long_::to_vector<unsigned long long>(big_list).empty());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+    big_list.decref();
+
+    py::list::object not_ints(1);
+    Py_INCREF(Py_None);
+    PyList_SET_ITEM((PyObject*) not_ints, 0, Py_None);
+    EXPECT_TRUE(py::long_::to_vector<int>(not_ints).empty());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+    not_ints.decref();
+
+    py::list::object null;
+    EXPECT_TRUE(py::long_::to_vector<int>(null).empty());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST(Long, from_span_unsigned) {
+    std::vector<unsigned long long> values = {0, ULLONG_MAX, 1ULL << 63};
+    auto list = py::long_::from_span(
+        py::span<const unsigned long long>(values));
+    ASSERT_TRUE(list.is_nonnull());
+    ASSERT_EQ(list.len(), 3);
+
+    for (std::size_t ix = 0; ix < values.size(); ++ix) {
+        EXPECT_EQ(PyLong_AsUnsignedLongLong(
+                      PyList_GET_ITEM((PyObject*) list, ix)), values[ix]);
+    }
+    EXPECT_EQ(py::long_::to_vector<unsigned long long>(list), values);
+    EXPECT_NO_PYTHON_ERR();
+}
+
+#if HAVE_INT128
+TEST(Long, int128) {
+    __int128 big = static_cast<__int128>(1) << 100;
+    auto expected = eval("2 ** 100");
+    ASSERT_TRUE(expected.is_nonnull());
+
+    auto ob = py::long_::object(big).as_tmpref();
+    EXPECT_TRUE((ob == expected).istrue());
+    EXPECT_TRUE(ob.as_int128() == big);
+    EXPECT_TRUE((-ob).as_int128() == -big);
+    EXPECT_NO_PYTHON_ERR();
+
+    __int128 max = ~(static_cast<unsigned __int128>(1) << 127);
+    auto max_ob = py::long_::object(max).as_tmpref();
+    EXPECT_TRUE((max_ob == eval("2 ** 127 - 1")).istrue());
+    EXPECT_TRUE(max_ob.as_int128() == max);
+    EXPECT_TRUE((-max_ob - 1_p).as_int128() == -max - 1);
+
+    unsigned __int128 umax = ~static_cast<unsigned __int128>(0);
+    auto umax_ob = py::long_::object(umax).as_tmpref();
+    EXPECT_TRUE((umax_ob == eval("2 ** 128 - 1")).istrue());
+    EXPECT_TRUE(umax_ob.as_uint128() == umax);
+    EXPECT_NO_PYTHON_ERR();
+
+    // small values still come back as the shared small ints
+    EXPECT_EQ((PyObject*) py::long_::object(static_cast<__int128>(5))
+              .as_tmpref(),
+              (PyObject*) 5_p);
+
+    EXPECT_TRUE(umax_ob.as_int128() == -1);
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+    EXPECT_TRUE(py::long_::object(-1).as_tmpref().as_uint128() ==
+                static_cast<unsigned __int128>(-1));
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+
+TEST(Long, int128_operators) {
+    __int128 big = static_cast<__int128>(1) << 100;
+    auto a = py::long_::object(3).as_tmpref();
+
+    EXPECT_TRUE(((a + big) == eval("3 + 2 ** 100")).istrue());
+    EXPECT_TRUE(((big - a) == eval("2 ** 100 - 3")).istrue());
+    EXPECT_TRUE(((a + static_cast<__int128>(4)) == 7_p).istrue());
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Long, int128_sequences) {
+    std::vector<__int128> values = {0,
+                                    -1,
+                                    static_cast<__int128>(1) << 100,
+                                    -(static_cast<__int128>(1) << 90)};
+    auto list = py::long_::from_span(py::span<const __int128>(values));
+    ASSERT_TRUE(list.is_nonnull());
+    EXPECT_TRUE((list[2_p] == eval("2 ** 100")).istrue());
+    EXPECT_TRUE(py::long_::to_vector<__int128>(list) == values);
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_TRUE(py::long_::to_vector<unsigned __int128>(list).empty());
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+#endif
+
+TEST(Long, bytes) {
+    const char big_endian[] = {'\x01', '\x02', '\x03'};
+    auto n = py::long_::from_bytes(big_endian,
+                                   py::long_::byteorder::big,
+                                   false);
+    ASSERT_TRUE(n.is_nonnull());
+    EXPECT_EQ(n.as_long(), 0x010203);
+
+    const char all_ones[] = {'\xff', '\xff'};
+    EXPECT_EQ(py::long_::from_bytes(all_ones).as_long(), -1);
+    EXPECT_EQ(py::long_::from_bytes(all_ones,
+                                    py::long_::byteorder::little,
+                                    false).as_long(),
+              0xffff);
+    EXPECT_EQ(py::long_::from_bytes(py::span<const char>()).as_long(), 0);
+    EXPECT_NO_PYTHON_ERR();
+
+    char out[3];
+    ASSERT_EQ(n.as_bytes(out, py::long_::byteorder::little), 0);
+    EXPECT_EQ(std::string(out, 3), "\x03\x02\x01");
+
+    char one[1];
+    EXPECT_EQ(py::long_::object(256).as_tmpref().as_bytes(one), -1);
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+}
+
+TEST(Long, bytes_array) {
+    auto values = eval("[0, -1, 2 ** 100, -(2 ** 120), 12345]");
+    ASSERT_TRUE(values.is_nonnull());
+    py::list::object list(values);
+
+    std::vector<char> packed(5 * 16);
+    ASSERT_EQ(py::long_::as_bytes_array(list,
+                                        packed,
+                                        16,
+                                        py::long_::byteorder::big),
+              0);
+
+    auto expected = eval("b''.join(n.to_bytes(16, 'big', signed=True)"
+                         " for n in [0, -1, 2 ** 100, -(2 ** 120), 12345])");
+    ASSERT_TRUE(expected.is_nonnull());
+    EXPECT_EQ(std::string(packed.begin(), packed.end()),
+              std::string(PyBytes_AS_STRING((PyObject*) expected),
+                          packed.size()));
+
+    auto back = py::long_::from_bytes_array(packed,
+                                            16,
+                                            py::long_::byteorder::big);
+    ASSERT_TRUE(back.is_nonnull());
+    EXPECT_EQ(PyObject_RichCompareBool(back, list, Py_EQ), 1);
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_FALSE(py::long_::from_bytes_array(packed, 7).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+
+    std::vector<char> small(5);
+    EXPECT_EQ(py::long_::as_bytes_array(list, small, 1), -1);
+    EXPECT_PYTHON_ERR(PyExc_OverflowError);
+
+    std::vector<char> short_buffer(4 * 16);
+    EXPECT_EQ(py::long_::as_bytes_array(list, short_buffer, 16), -1);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+}
+
+TEST(Long, box_cache) {
+    py::long_::box_cache_info info = py::long_::box_cache_stats();
+    EXPECT_GT(info.low, info.high);
+    EXPECT_EQ(info.hit_rate(), 0.0);
+
+    ASSERT_EQ(py::long_::enable_box_cache(-10, 65535), 0);
+    info = py::long_::box_cache_stats();
+    EXPECT_EQ(info.low, -10);
+    EXPECT_EQ(info.high, 65535);
+    EXPECT_EQ(info.hits, 0u);
+    EXPECT_EQ(info.misses, 0u);
+    EXPECT_GT(info.bytes, 65546 * sizeof(PyObject*));
+
+    // constructors and operator results in the range share one object
+    auto a = py::long_::object(1000).as_tmpref();
+    auto b = py::long_::object(1000u).as_tmpref();
+    auto c = py::long_::object(999).as_tmpref() + 1;
+    EXPECT_EQ((PyObject*) a, (PyObject*) b);
+    EXPECT_EQ((PyObject*) a, (PyObject*) c);
+    EXPECT_EQ(PyLong_AsLong(a), 1000);
+
+    // values outside of the range allocate
+    auto d = py::long_::object(65536).as_tmpref();
+    auto e = py::long_::object(65536).as_tmpref();
+    EXPECT_NE((PyObject*) d, (PyObject*) e);
+    EXPECT_EQ(PyLong_AsLong(d), 65536);
+
+    info = py::long_::box_cache_stats();
+    EXPECT_EQ(info.hits, 4u);
+    EXPECT_EQ(info.misses, 2u);
+    EXPECT_DOUBLE_EQ(info.hit_rate(), 4.0 / 6.0);
+
+    // a cached temporary is shared with the table so it is never reused
+    py::tmpref<py::long_::object> f = std::move(c) + 1_p;
+    EXPECT_EQ(PyLong_AsLong(a), 1000);
+    EXPECT_EQ(PyLong_AsLong(f), 1001);
+
+    py::long_::disable_box_cache();
+    info = py::long_::box_cache_stats();
+    EXPECT_GT(info.low, info.high);
+    EXPECT_EQ(info.bytes, 0u);
+    auto g = py::long_::object(1000).as_tmpref();
+    EXPECT_NE((PyObject*) a, (PyObject*) g);
+    EXPECT_NO_PYTHON_ERR();
+
+    EXPECT_EQ(py::long_::enable_box_cache(1, 0), -1);
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+    EXPECT_EQ(py::long_::enable_box_cache(LLONG_MIN, LLONG_MAX), -1);
+    EXPECT_PYTHON_ERR(PyExc_MemoryError);
+    EXPECT_GT(py::long_::box_cache_stats().low,
+              py::long_::box_cache_stats().high);
+}
+
+TEST(Long, box_cache_subinterpreter) {
+    ASSERT_EQ(py::long_::enable_box_cache(0, 2000), 0);
+    PyObject *cached = py::long_::_box(1000);
+    ASSERT_NE(cached, nullptr);
+
+    PyThreadState *main = PyThreadState_Get();
+    PyThreadState *sub = Py_NewInterpreter();
+    ASSERT_NE(sub, nullptr);
+
+    // the cached objects belong to the main interpreter
+    {
+        auto a = py::long_::object(1000).as_tmpref();
+        auto b = py::long_::object(1000).as_tmpref();
+        EXPECT_NE((PyObject*) a, cached);
+        EXPECT_NE((PyObject*) a, (PyObject*) b);
+        EXPECT_EQ(PyLong_AsLong(a), 1000);
+    }
+    EXPECT_EQ(py::long_::enable_box_cache(0, 10), -1);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+    py::long_::disable_box_cache();
+
+    Py_EndInterpreter(sub);
+    PyThreadState_Swap(main);
+
+    py::long_::box_cache_info info = py::long_::box_cache_stats();
+    EXPECT_EQ(info.high, 2000);
+    EXPECT_EQ(info.hits, 1u);
+    EXPECT_EQ(info.misses, 0u);
+    PyObject *again = py::long_::_box(1000);
+    EXPECT_EQ(again, cached);
+    Py_DECREF(again);
+    Py_DECREF(cached);
+    py::long_::disable_box_cache();
+    EXPECT_NO_PYTHON_ERR();
+}
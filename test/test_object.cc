@@ -131,3 +131,215 @@ TEST_F(Object, setitem_syntax) {
     // make sure that the value hasn't changed
     EXPECT_TRUE((immutable_container[0_p] == 1_p).istrue());
 }
+
+TEST_F(Object, call) {
+    PyObject *ns = PyEval_GetBuiltins();
+    py::object f = PyRun_String("lambda *args: args",
+                                Py_eval_input,
+                                ns,
+                                ns);
+    ASSERT_TRUE(f.is_nonnull());
+
+    py::object empty = f();
+    ASSERT_TRUE(empty.is_nonnull());
+    EXPECT_EQ(empty.len(), 0);
+    empty.decref();
+
+    py::object res = f(1_p, "a"_p, 2.5_p);
+    ASSERT_TRUE(res.is_nonnull());
+    ASSERT_EQ(res.len(), 3);
+    EXPECT_TRUE((res[0_p] == 1_p).istrue());
+    EXPECT_TRUE((res[1_p] == "a"_p).istrue());
+    EXPECT_TRUE((res[2_p] == 2.5_p).istrue());
+    EXPECT_EQ(res.refcnt(), 1);
+    res.decref();
+
+    // calling with a null argument should propagate the failure
+    EXPECT_FALSE(f(1_p, py::object(nullptr)).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    f.decref();
+}
+
+TEST_F(Object, call_keywords) {
+    using py::operator""_kw;
+
+    PyObject *ns = PyEval_GetBuiltins();
+    py::object f = PyRun_String("lambda *args, **kwargs: (args, kwargs)",
+                                Py_eval_input,
+                                ns,
+                                ns);
+    ASSERT_TRUE(f.is_nonnull());
+
+    for (int n = 0; n < 2; ++n) {
+        // run twice to exercise the cached keyword names
+        py::object res = f(1_p, "b"_kw = 2_p, "c"_kw = "c"_p);
+        ASSERT_TRUE(res.is_nonnull());
+
+        py::object args = res[0_p];
+        ASSERT_EQ(args.len(), 1);
+        EXPECT_TRUE((args[0_p] == 1_p).istrue());
+
+        py::object kwargs = res[1_p];
+        ASSERT_EQ(kwargs.len(), 2);
+        EXPECT_TRUE((kwargs["b"_p] == 2_p).istrue());
+        EXPECT_TRUE((kwargs["c"_p] == "c"_p).istrue());
+        res.decref();
+    }
+
+    py::object only_keywords = f("a"_kw = 1_p);
+    ASSERT_TRUE(only_keywords.is_nonnull());
+    EXPECT_EQ(only_keywords[0_p].len(), 0);
+    EXPECT_TRUE((only_keywords[1_p]["a"_p] == 1_p).istrue());
+    only_keywords.decref();
+
+    // a null keyword value should propagate the failure
+    EXPECT_FALSE(f("a"_kw = py::object(nullptr)).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    f.decref();
+}
+
+TEST_F(Object, call_method) {
+    using py::operator""_kw;
+
+    py::object ob = "ayy.lmao"_p;
+    py::object idx = ob.call_method("find"_p, "."_p);
+    ASSERT_TRUE(idx.is_nonnull());
+    EXPECT_TRUE((idx == 3_p).istrue());
+    idx.decref();
+
+    py::object parts = ob.call_method("split"_p, "sep"_kw = "."_p);
+    ASSERT_TRUE(parts.is_nonnull());
+    ASSERT_EQ(parts.len(), 2);
+    EXPECT_TRUE((parts[0_p] == "ayy"_p).istrue());
+    parts.decref();
+
+    // attributes stored on the instance must be found through a normal
+    // getattr
+    PyObject *ns = PyEval_GetBuiltins();
+    py::object instance = C();
+    ASSERT_TRUE(instance.is_nonnull());
+    py::object f = PyRun_String("lambda a: a + 1", Py_eval_input, ns, ns);
+    ASSERT_EQ(instance.setattr("f"_p, f), 0);
+    py::object res = instance.call_method("f"_p, 1_p);
+    ASSERT_TRUE(res.is_nonnull());
+    EXPECT_TRUE((res == 2_p).istrue());
+    res.decref();
+    f.decref();
+    instance.decref();
+
+    EXPECT_FALSE(ob.call_method("invalid"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+}
+
+TEST_F(Object, getattr_cached) {
+    PyObject *ns = PyEval_GetBuiltins();
+    py::object D = PyRun_String(
+        "type('D', (), {'a': 1, 'p': property(lambda self: 2),"
+        " 'f': lambda self: self})",
+        Py_eval_input,
+        ns,
+        ns);
+    ASSERT_TRUE(D.is_nonnull());
+    py::object instance = D();
+    ASSERT_TRUE(instance.is_nonnull());
+    ASSERT_EQ(instance.setattr("b"_p, 3_p), 0);
+
+    py::attr_cache a_cache;
+    py::attr_cache p_cache;
+    py::attr_cache f_cache;
+    py::attr_cache b_cache;
+
+    for (int n = 0; n < 2; ++n) {
+        // run twice to hit the cache the second time
+        EXPECT_EQ((PyObject*) instance.getattr(a_cache, "a"_p),
+                  (PyObject*) 1_p);
+        EXPECT_EQ((PyObject*) instance.getattr(p_cache, "p"_p),
+                  (PyObject*) 2_p);
+        py::tmpref<py::object> f = instance.getattr(f_cache, "f"_p);
+        ASSERT_TRUE(f.is_nonnull());
+        EXPECT_EQ((PyObject*) f(), (PyObject*) instance);
+        EXPECT_EQ((PyObject*) instance.getattr(b_cache, "b"_p),
+                  (PyObject*) 3_p);
+    }
+
+    // instance attributes shadow non-data descriptors
+    ASSERT_EQ(instance.setattr("a"_p, 4_p), 0);
+    EXPECT_EQ((PyObject*) instance.getattr(a_cache, "a"_p), (PyObject*) 4_p);
+    ASSERT_EQ(instance.delattr("a"_p), 0);
+
+    // modifying the type invalidates the cache
+    ASSERT_EQ(D.setattr("a"_p, 5_p), 0);
+    EXPECT_EQ((PyObject*) instance.getattr(a_cache, "a"_p), (PyObject*) 5_p);
+
+    EXPECT_FALSE(instance.getattr(b_cache, "invalid"_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AttributeError);
+
+    instance.decref();
+    D.decref();
+}
+
+namespace {
+/**
+   The number of times `counting_getattro` was called.
+*/
+int getattro_calls = 0;
+
+PyObject *counting_getattro(PyObject *ob, PyObject *name) {
+    ++getattro_calls;
+    return PyObject_GenericGetAttr(ob, name);
+}
+}  // namespace
+
+TEST_F(Object, getattr_cached_plain_class) {
+    PyObject *ns = PyEval_GetBuiltins();
+    py::object E = PyRun_String("type('E', (), {'f': lambda self: 1})",
+                                Py_eval_input,
+                                ns,
+                                ns);
+    ASSERT_TRUE(E.is_nonnull());
+    py::object instance = E();
+    ASSERT_TRUE(instance.is_nonnull());
+    ASSERT_EQ(instance.setattr("b"_p, 3_p), 0);
+
+    py::attr_cache f_cache;
+    py::attr_cache b_cache;
+    ASSERT_TRUE(instance.getattr(f_cache, "f"_p).is_nonnull());
+    ASSERT_TRUE(instance.getattr(b_cache, "b"_p).is_nonnull());
+
+    // once the caches are filled, lookups do not go through `tp_getattro`,
+    // which also covers classes with a managed dict
+    PyTypeObject *tp = (PyTypeObject*) (PyObject*) E;
+    tp->tp_getattro = counting_getattro;
+    getattro_calls = 0;
+    py::tmpref<py::object> f = instance.getattr(f_cache, "f"_p);
+    ASSERT_TRUE(f.is_nonnull());
+    EXPECT_EQ((PyObject*) f(), (PyObject*) 1_p);
+    EXPECT_EQ((PyObject*) instance.getattr(b_cache, "b"_p), (PyObject*) 3_p);
+    EXPECT_EQ(getattro_calls, 0);
+    tp->tp_getattro = PyObject_GenericGetAttr;
+
+    // instance attributes still shadow methods
+    ASSERT_EQ(instance.setattr("f"_p, 4_p), 0);
+    EXPECT_EQ((PyObject*) instance.getattr(f_cache, "f"_p), (PyObject*) 4_p);
+
+    instance.decref();
+    E.decref();
+}
+
+TEST(AttrCache, reinitialize) {
+    py::attr_cache cache;
+    ASSERT_TRUE("abc"_p.getattr(cache, "upper"_p).is_nonnull());
+
+    // the cached entry refers to objects of the finalized interpreter, it
+    // must be dropped without touching them
+    Py_Finalize();
+    Py_Initialize();
+
+    py::tmpref<py::object> upper = "abc"_p.getattr(cache, "upper"_p);
+    ASSERT_TRUE(upper.is_nonnull());
+    EXPECT_STREQ(PyUnicode_AsUTF8(upper()), "ABC");
+    cache.clear();
+    EXPECT_NO_PYTHON_ERR();
+}
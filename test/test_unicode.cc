@@ -0,0 +1,324 @@
+#include <string>
+
+#include <gtest/gtest.h>
+#include <Python.h>
+
+#include "libpy/libpy.h"
+
+#include "utils.h"
+
+using py::operator""_p;
+
+TEST(Unicode, type) {
+    ASSERT_EQ((PyObject*) py::unicode::type, (PyObject*) &PyUnicode_Type);
+    auto t = py::unicode::type();
+
+    EXPECT_EQ((PyObject*) t.type(), (PyObject*) &PyUnicode_Type);
+}
+
+TEST(Unicode, from_non_str) {
+    py::unicode::object ob(1_p);
+
+    EXPECT_FALSE(ob.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Unicode, as_string_view) {
+    py::unicode::object ascii("abc.def"_p);
+    auto view = ascii.as_string_view();
+
+    ASSERT_EQ(view.size(), 7ul);
+    EXPECT_EQ(std::string(view.data(), view.size()), "abc.def");
+    // compact ascii strings share their utf-8 with the character storage
+    EXPECT_EQ(view.data(), PyUnicode_AsUTF8((PyObject*) ascii));
+
+    py::unicode::object wide(L"\u00e9\u4e2d"_p);
+    view = wide.as_string_view();
+    EXPECT_EQ(std::string(view.data(), view.size()), "\xc3\xa9\xe4\xb8\xad");
+    // the utf-8 is cached so the second view points at the same bytes
+    EXPECT_EQ(wide.as_string_view().data(), view.data());
+
+    py::unicode::object null;
+    view = null.as_string_view();
+    EXPECT_EQ(view.data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+TEST(Unicode, kind_views) {
+    py::unicode::object ucs1(L"a\u00e9"_p);
+    py::unicode::object ucs2(L"a\u4e2d"_p);
+    py::unicode::object ucs4(L"a\U0001f600"_p);
+
+    ASSERT_EQ(ucs1.kind(), PyUnicode_1BYTE_KIND);
+    ASSERT_EQ(ucs2.kind(), PyUnicode_2BYTE_KIND);
+    ASSERT_EQ(ucs4.kind(), PyUnicode_4BYTE_KIND);
+
+    auto v1 = ucs1.as_ucs1();
+    ASSERT_EQ(v1.size(), 2ul);
+    EXPECT_EQ(v1[0], 'a');
+    EXPECT_EQ(v1[1], 0xe9);
+
+    auto v2 = ucs2.as_ucs2();
+    ASSERT_EQ(v2.size(), 2ul);
+    EXPECT_EQ(v2[0], 'a');
+    EXPECT_EQ(v2[1], 0x4e2d);
+
+    auto v4 = ucs4.as_ucs4();
+    ASSERT_EQ(v4.size(), 2ul);
+    EXPECT_EQ(v4[0], 'a');
+    EXPECT_EQ(v4[1], 0x1f600u);
+
+    EXPECT_EQ(ucs1.as_ucs2().data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+
+    EXPECT_EQ(ucs4.as_ucs1().data(), nullptr);
+    EXPECT_PYTHON_ERR(PyExc_TypeError);
+}
+
+TEST(Unicode, read_char) {
+    py::unicode::object ob(L"a\u00e9\u4e2d\U0001f600"_p);
+
+    ASSERT_EQ(ob.len(), 4);
+    EXPECT_EQ(ob.read_char(0), (Py_UCS4) 'a');
+    EXPECT_EQ(ob.read_char(1), (Py_UCS4) 0xe9);
+    EXPECT_EQ(ob.read_char(2), (Py_UCS4) 0x4e2d);
+    EXPECT_EQ(ob.read_char(3), (Py_UCS4) 0x1f600);
+
+    EXPECT_EQ(ob.read_char_checked(3), (Py_UCS4) 0x1f600);
+    EXPECT_EQ(ob.read_char_checked(4), (Py_UCS4) -1);
+    EXPECT_PYTHON_ERR(PyExc_IndexError);
+    EXPECT_EQ(ob.read_char_checked(-1), (Py_UCS4) -1);
+    EXPECT_PYTHON_ERR(PyExc_IndexError);
+
+    auto nn = ob.as_nonnull();
+    EXPECT_EQ(nn.len(), 4);
+    EXPECT_EQ(nn.kind(), PyUnicode_4BYTE_KIND);
+    EXPECT_EQ(nn.read_char(2), (Py_UCS4) 0x4e2d);
+}
+
+TEST(Unicode, nonnull) {
+    py::unicode::object null;
+    EXPECT_THROW(null.as_nonnull(), pyutils::bad_nonnull);
+    EXPECT_EQ(null.len(), -1);
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+}
+
+namespace {
+    /**
+       Build a str which is long enough to exercise the vectorized loops and
+       their scalar tails.
+    */
+    py::unicode::object make_line(const char *piece, int repeat) {
+        std::string s;
+        for (int n = 0; n < repeat; ++n) {
+            s += piece;
+            s += std::to_string(n);
+        }
+        return PyUnicode_DecodeLatin1(s.data(), s.size(), nullptr);
+    }
+
+    /**
+       Compare the result of a libpy str method to the result of calling the
+       method through Python.
+    */
+    void expect_same(const py::object &actual,
+                     const py::unicode::object &ob,
+                     const py::object &method,
+                     const py::object &arg) {
+        auto expected = ob.getattr(method)(arg);
+        ASSERT_TRUE(expected.is_nonnull());
+        ASSERT_TRUE(actual.is_nonnull());
+        EXPECT_EQ(PyObject_RichCompareBool((PyObject*) actual,
+                                           (PyObject*) expected,
+                                           Py_EQ), 1);
+    }
+}
+
+TEST(Unicode, find_count_startswith) {
+    std::array<const char*, 3> pieces = {"a,b", "lorem ipsum ", "\xe9t\xe9;"};
+    std::array<py::object, 7> subs = {","_p,
+                                      "9"_p,
+                                      "ipsum"_p,
+                                      "m 1"_p,
+                                      ""_p,
+                                      "missing"_p,
+                                      L"中"_p};
+
+    for (const char *piece : pieces) {
+        for (int repeat : {0, 1, 3, 17, 100}) {
+            auto ob = make_line(piece, repeat);
+            for (const auto &sub : subs) {
+                auto find = ob.find(sub);
+                ASSERT_NE(find, -2);
+                expect_same(py::object(PyLong_FromSsize_t(find)).as_tmpref(),
+                            ob,
+                            "find"_p,
+                            sub);
+
+                auto count = ob.count(sub);
+                ASSERT_NE(count, -1);
+                expect_same(py::object(PyLong_FromSsize_t(count)).as_tmpref(),
+                            ob,
+                            "count"_p,
+                            sub);
+
+                int startswith = ob.startswith(sub);
+                ASSERT_NE(startswith, -1);
+                expect_same(py::object(PyBool_FromLong(startswith))
+                            .as_tmpref(),
+                            ob,
+                            "startswith"_p,
+                            sub);
+            }
+        }
+    }
+}
+
+TEST(Unicode, split) {
+    std::array<const char*, 3> pieces = {"a,b", "a,,", "lorem ipsum "};
+    std::array<py::object, 3> seps = {","_p, ",,"_p, " "_p};
+
+    for (const char *piece : pieces) {
+        for (int repeat : {0, 1, 3, 17, 100}) {
+            auto ob = make_line(piece, repeat);
+            for (const auto &sep : seps) {
+                expect_same(ob.split(sep), ob, "split"_p, sep);
+
+                auto limited = ob.split(sep, 2);
+                auto expected = ob.getattr("split"_p)(sep, 2_p);
+                EXPECT_EQ(PyObject_RichCompareBool((PyObject*) limited,
+                                                   (PyObject*) expected,
+                                                   Py_EQ), 1);
+            }
+        }
+    }
+
+    py::unicode::object ob("a,b"_p);
+    EXPECT_FALSE(ob.split(""_p).is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_ValueError);
+
+    py::unicode::object wide(L"a中b中c"_p);
+    expect_same(wide.split(L"中"_p), wide, "split"_p, L"中"_p);
+}
+
+TEST(Unicode, whitespace) {
+    std::array<py::object, 6> inputs = {""_p,
+                                        "   "_p,
+                                        "abc"_p,
+                                        " \t a  b\x1f c\r\n"_p,
+                                        "\x0b\x0c x \x1c"_p,
+                                        L" a b "_p};
+
+    for (const auto &input : inputs) {
+        py::unicode::object ob(input);
+
+        auto split = ob.split();
+        auto expected_split = ob.getattr("split"_p)();
+        EXPECT_EQ(PyObject_RichCompareBool((PyObject*) split,
+                                           (PyObject*) expected_split,
+                                           Py_EQ), 1);
+
+        auto strip = ob.strip();
+        auto expected_strip = ob.getattr("strip"_p)();
+        EXPECT_EQ(PyObject_RichCompareBool((PyObject*) strip,
+                                           (PyObject*) expected_strip,
+                                           Py_EQ), 1);
+    }
+
+    // nothing to strip returns the same object
+    py::unicode::object ob("abc"_p);
+    EXPECT_EQ((PyObject*) ob.strip(), (PyObject*) ob);
+}
+
+TEST(Unicode, builder) {
+    py::unicode::builder b;
+    b.append("ascii ")
+        .append(L"é"_p)
+        .append(' ')
+        .append(std::string("\xe4\xb8\xad"))
+        .append(' ')
+        .append(-12)
+        .append(' ')
+        .append(12ull)
+        .append(' ')
+        .append(2.5)
+        .append(' ')
+        .append(true)
+        .append(' ')
+        .append(py::object(PyLong_FromLong(5)).as_tmpref())
+        .append(L"\U0001f600"_p);
+    EXPECT_EQ(b.len(), 28);
+
+    auto ob = b.build();
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_EQ(ob.kind(), PyUnicode_4BYTE_KIND);
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) ob,
+                                (PyObject*) L"ascii é 中 -12 12 2.5 "
+                                            L"True 5\U0001f600"_p), 0);
+
+    // the builder is reset after building
+    EXPECT_EQ(b.len(), 0);
+    auto ascii = b.append("a").append(1).append("b").build();
+    EXPECT_EQ(ascii.kind(), PyUnicode_1BYTE_KIND);
+    EXPECT_TRUE(PyUnicode_IS_ASCII((PyObject*) ascii));
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) ascii, (PyObject*) "a1b"_p), 0);
+
+    // a single str is returned as is
+    auto same = b.append("abc"_p).build();
+    EXPECT_EQ((PyObject*) same, (PyObject*) "abc"_p);
+}
+
+TEST(Unicode, builder_raw_object) {
+    // a borrowed `PyObject*` is appended as `str(ob)`, not as a bool
+    py::object five(PyLong_FromLong(5));
+    PyObject *raw = five;
+    auto ob = py::unicode::builder().append("v=").append(raw).build();
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) ob, (PyObject*) "v=5"_p), 0);
+
+    using py::operator""_fmt;
+    auto formatted = "v={}"_fmt(raw);
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) formatted, (PyObject*) "v=5"_p),
+              0);
+
+    char text[] = "abc";
+    auto chars = py::unicode::builder().append(&text[0]).build();
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) chars, (PyObject*) "abc"_p), 0);
+    five.decref();
+    EXPECT_NO_PYTHON_ERR();
+}
+
+TEST(Unicode, builder_errors) {
+    py::unicode::builder b;
+    py::object null;
+    auto ob = b.append("a").append(null).append("b").build();
+    EXPECT_FALSE(ob.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_AssertionError);
+
+    ob = b.append("\xff").build();
+    EXPECT_FALSE(ob.is_nonnull());
+    EXPECT_PYTHON_ERR(PyExc_UnicodeDecodeError);
+
+    // failures do not stick after build
+    ob = b.append("a").build();
+    EXPECT_TRUE(ob.is_nonnull());
+}
+
+TEST(Unicode, format) {
+    using py::operator""_fmt;
+
+    auto ob = "{}: {} {{{}}}"_fmt("key"_p, 1.5, 3);
+    ASSERT_TRUE(ob.is_nonnull());
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) ob, (PyObject*) "key: 1.5 {3}"_p),
+              0);
+
+    auto empty = ""_fmt();
+    EXPECT_EQ(empty.len(), 0);
+
+    auto no_fields = "}}{{"_fmt();
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) no_fields, (PyObject*) "}{"_p),
+              0);
+
+    auto wide = "\xe4\xb8\xad{}"_fmt(L"\U0001f600"_p);
+    EXPECT_EQ(PyUnicode_Compare((PyObject*) wide,
+                                (PyObject*) L"中\U0001f600"_p), 0);
+}
@@ -4,8 +4,25 @@
 
 #include "libpy/libpy.h"
 
+#include "utils.h"
+
 using py::operator""_p;
 
+/**
+   Get the slot for a string literal without using the literal.
+*/
+template<typename C, C... cs>
+PyObject *operator""_slot() {
+    return py::_literal<py::_string_literal<C, cs...>>::ob;
+}
+
+/**
+   A literal which is only used by `warm_literals`.
+*/
+PyObject *never_called() {
+    return "warm_literals_only"_p;
+}
+
 TEST(UserDefinedLiterals, char) {
     py::object c = 'c'_p;
     EXPECT_EQ((PyObject*) c.type(), (PyObject*) &PyUnicode_Type);
@@ -22,6 +39,40 @@ TEST(UserDefinedLiterals, string) {
     EXPECT_TRUE((cs == "test"_p).istrue());
 }
 
+TEST(UserDefinedLiterals, string_cached) {
+    // each literal has a single cached object
+    EXPECT_EQ((PyObject*) "cached"_p, (PyObject*) "cached"_p);
+    EXPECT_NE((PyObject*) "cached"_p, (PyObject*) "other"_p);
+    EXPECT_EQ((PyObject*) 'c'_p, (PyObject*) 'c'_p);
+
+    py::object empty = ""_p;
+    EXPECT_EQ(PyUnicode_GET_LENGTH((PyObject*) empty), 0);
+}
+
+TEST(UserDefinedLiterals, string_interned) {
+    PyObject *cs = "interned"_p;
+    EXPECT_TRUE(PyUnicode_CHECK_INTERNED(cs));
+
+    PyObject *other = PyUnicode_InternFromString("interned");
+    EXPECT_EQ(cs, other);
+    Py_DECREF(other);
+
+    EXPECT_TRUE(PyUnicode_CHECK_INTERNED((PyObject*) L"interned"_p));
+    EXPECT_TRUE(PyUnicode_CHECK_INTERNED((PyObject*) 'c'_p));
+}
+
+TEST(UserDefinedLiterals, warm_literals) {
+    py::clear_literals();
+    EXPECT_EQ("warm_literals_only"_slot, nullptr);
+    EXPECT_EQ(py::warm_literals(), 0);
+    EXPECT_NO_PYTHON_ERR();
+
+    PyObject *ob = "warm_literals_only"_slot;
+    ASSERT_NE(ob, nullptr);
+    EXPECT_STREQ(PyUnicode_AsUTF8(ob), "warm_literals_only");
+    EXPECT_TRUE(PyUnicode_CHECK_INTERNED(ob));
+}
+
 TEST(UserDefinedLiterals, wchar_t) {
     py::object c = L'c'_p;
     EXPECT_EQ((PyObject*) c.type(), (PyObject*) &PyUnicode_Type);
@@ -49,9 +100,102 @@ TEST(UserDefinedLiterals, ull) {
     EXPECT_TRUE((n == 10_p).istrue());
 }
 
+TEST(UserDefinedLiterals, ull_forms) {
+    EXPECT_EQ(0x1f_p .as_long(), 0x1f);
+    EXPECT_EQ(0X1F_p .as_long(), 0x1f);
+    EXPECT_EQ(0b101_p .as_long(), 5);
+    EXPECT_EQ(017_p .as_long(), 15);
+    EXPECT_EQ(0_p .as_long(), 0);
+    EXPECT_EQ(1'000'000_p .as_long(), 1000000);
+
+    py::object max = 18446744073709551615_p;
+    EXPECT_EQ(PyLong_AsUnsignedLongLong((PyObject*) max), ~0ULL);
+
+    EXPECT_EQ((PyObject*) 10_p, (PyObject*) 10_p);
+}
+
 TEST(UserDefinedLiterals, longdouble) {
     py::object n = 2.5_p;
     EXPECT_EQ((PyObject*) n.type(), (PyObject*) &PyFloat_Type);
     EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) n), 2.5);
     EXPECT_TRUE((n == 2.5_p).istrue());
 }
+
+TEST(UserDefinedLiterals, float_forms) {
+    EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) 1e3_p), 1000.0);
+    EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) 1.5E-1_p), 0.15);
+    EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) 1'000.5_p), 1000.5);
+    EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) 0x1p4_p), 16.0);
+    EXPECT_EQ(PyFloat_AS_DOUBLE((PyObject*) .5_p), 0.5);
+
+    EXPECT_EQ((PyObject*) 2.5_p, (PyObject*) 2.5_p);
+}
+
+TEST(UserDefinedLiterals, clear_literals) {
+    PyObject *before = "cleared"_p;
+    ASSERT_NE(before, nullptr);
+    Py_INCREF(before);
+    Py_ssize_t refcnt = Py_REFCNT(before);
+
+    py::clear_literals();
+    EXPECT_EQ("cleared"_slot, nullptr);
+#if PY_VERSION_HEX >= 0x030C0000
+    // interned strings are immortal so their refcount does not move
+    if (!_Py_IsImmortal(before))
+#endif
+    {
+        EXPECT_EQ(Py_REFCNT(before), refcnt - 1);
+    }
+    Py_DECREF(before);
+
+    PyObject *after = "cleared"_p;
+    ASSERT_NE(after, nullptr);
+    EXPECT_STREQ(PyUnicode_AsUTF8(after), "cleared");
+    EXPECT_TRUE((10_p == py::long_::object(10)).istrue());
+    EXPECT_TRUE(('c'_p == "c"_p).istrue());
+}
+
+TEST(UserDefinedLiterals, reinitialize) {
+    EXPECT_STREQ(PyUnicode_AsUTF8("reinitialize"_p), "reinitialize");
+
+    Py_Finalize();
+    EXPECT_EQ("reinitialize"_slot, nullptr);
+    Py_Initialize();
+
+    EXPECT_STREQ(PyUnicode_AsUTF8("reinitialize"_p), "reinitialize");
+    EXPECT_TRUE(PyUnicode_CHECK_INTERNED((PyObject*) "reinitialize"_p));
+    EXPECT_EQ(PyLong_AsLong(12345_p), 12345);
+}
+
+TEST(UserDefinedLiterals, subinterpreter) {
+    // the main interpreter owns the caches
+    ASSERT_EQ(py::warm_literals(), 0);
+    ASSERT_NE((PyObject*) "x"_p, nullptr);
+    ASSERT_NE((PyObject*) 'x'_p, nullptr);
+
+    PyThreadState *main = PyThreadState_Get();
+    PyThreadState *sub = Py_NewInterpreter();
+    ASSERT_NE(sub, nullptr);
+
+    // the caches are not per-interpreter so a subinterpreter may not
+    // fill them
+    EXPECT_EQ(py::warm_literals(), -1);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+    EXPECT_EQ((PyObject*) L'☃'_p, nullptr);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+
+    // nor read the objects which the main interpreter filled
+    EXPECT_EQ((PyObject*) "x"_p, nullptr);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+    EXPECT_EQ((PyObject*) 'x'_p, nullptr);
+    EXPECT_PYTHON_ERR(PyExc_RuntimeError);
+
+    Py_EndInterpreter(sub);
+    PyThreadState_Swap(main);
+
+    EXPECT_STREQ(PyUnicode_AsUTF8(L'☃'_p), "☃");
+    EXPECT_STREQ(PyUnicode_AsUTF8("x"_p), "x");
+    EXPECT_STREQ(PyUnicode_AsUTF8('x'_p), "x");
+    EXPECT_EQ(py::warm_literals(), 0);
+    EXPECT_NO_PYTHON_ERR();
+}
@@ -1,6 +1,8 @@
 #include <string>
 #include <cxxabi.h>
 
+#include "utils.h"
+
 std::string demangle(const char *name) {
     int status;
     char *cs = abi::__cxa_demangle(name, 0, 0, &status);
@@ -8,3 +10,16 @@ std::string demangle(const char *name) {
     free(cs);
     return std::move(ret);
 }
+
+py::tmpref<py::object> eval(const char *expr) {
+    PyObject *ns = PyEval_GetBuiltins();
+    return PyRun_String(expr, Py_eval_input, ns, ns);
+}
+
+void expect_same(const py::object &result, py::tmpref<py::object> expected) {
+    ASSERT_TRUE(result.is_nonnull());
+    ASSERT_TRUE(expected.is_nonnull());
+    EXPECT_EQ((PyObject*) result.type(), (PyObject*) expected.type());
+    EXPECT_EQ(PyObject_RichCompareBool(result, expected, Py_EQ), 1);
+    EXPECT_NO_PYTHON_ERR();
+}
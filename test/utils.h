@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 #include <Python.h>
 
+#include "libpy/object.h"
+
 /**
    Expectation that no python errors have been raised.
    When this fails the exception is printed with PyErr_Print and then it is
@@ -39,3 +41,21 @@
    @return     The demangled named.
 */
 std::string demangle(const char *name);
+
+/**
+   Evaluate a Python expression with the builtins as the namespace.
+
+   @param expr The expression to evaluate.
+   @return     The result or nullptr with a Python exception set.
+*/
+py::tmpref<py::object> eval(const char *expr);
+
+/**
+   Expectation that `result` has the same type and compares equal to
+   `expected`.
+
+   @param result   The value under test.
+   @param expected The value to compare against, this reference is
+                   released.
+*/
+void expect_same(const py::object &result, py::tmpref<py::object> expected);